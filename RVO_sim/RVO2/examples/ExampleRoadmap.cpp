@@ -66,6 +66,7 @@
 #include <ctime>
 #include <iostream>
 #include <map>
+#include <utility>
 #include <vector>
 
 #ifdef _OPENMP
@@ -91,6 +92,16 @@ std::vector<RoadmapVertex> roadmap;
 /* Store the goals of the agents. */
 std::vector<int> goals;
 
+/*
+ * Store the visible roadmap vertex each agent steers toward, and the region
+ * (cell of a square grid) the agent was in when it was last chosen.
+ */
+std::vector<int> waypoints;
+std::vector<std::pair<int, int> > waypointRegions;
+
+/* Side length of the regions within which a waypoint is reused. */
+const float regionSize = 5.0f;
+
 void setupScenario(RVO::RVOSimulator *sim)
 {
 	/* Seed the random number generator. */
@@ -224,8 +235,18 @@ void buildRoadmap(RVO::RVOSimulator *sim)
 #pragma omp parallel for
 #endif
 	for (int i = 0; i < static_cast<int>(roadmap.size()); ++i) {
+		std::vector<RVO::Vector2> points1(roadmap.size(), roadmap[i].position);
+		std::vector<RVO::Vector2> points2(roadmap.size());
+		std::vector<bool> visible;
+
+		for (int j = 0; j < static_cast<int>(roadmap.size()); ++j) {
+			points2[j] = roadmap[j].position;
+		}
+
+		sim->queryVisibility(points1, points2, visible, sim->getAgentRadius(0));
+
 		for (int j = 0; j < static_cast<int>(roadmap.size()); ++j) {
-			if (sim->queryVisibility(roadmap[i].position, roadmap[j].position, sim->getAgentRadius(0))) {
+			if (visible[j]) {
 				roadmap[i].neighbors.push_back(j);
 			}
 		}
@@ -287,18 +308,39 @@ void setPreferredVelocities(RVO::RVOSimulator *sim)
 #pragma omp parallel for
 #endif
 	for (int i = 0; i < static_cast<int>(sim->getNumAgents()); ++i) {
-		float minDist = 9e9f;
-		int minVertex = -1;
+		const RVO::Vector2 position = sim->getAgentPosition(i);
+		const std::pair<int, int> region(static_cast<int>(std::floor(position.x() / regionSize)), static_cast<int>(std::floor(position.y() / regionSize)));
 
-		for (int j = 0; j < static_cast<int>(roadmap.size()); ++j) {
-			if (RVO::abs(roadmap[j].position - sim->getAgentPosition(i)) + roadmap[j].distToGoal[goals[i]] < minDist &&
-				sim->queryVisibility(sim->getAgentPosition(i), roadmap[j].position, sim->getAgentRadius(i))) {
+		/*
+		 * Choose a new waypoint only when the agent entered another region, or
+		 * came close to its current waypoint and may see past it.
+		 */
+		if (waypoints[i] == -1 || region != waypointRegions[i] ||
+			RVO::absSq(roadmap[waypoints[i]].position - position) < regionSize * regionSize) {
+			std::vector<RVO::Vector2> points1(roadmap.size(), position);
+			std::vector<RVO::Vector2> points2(roadmap.size());
+			std::vector<bool> visible;
+
+			for (int j = 0; j < static_cast<int>(roadmap.size()); ++j) {
+				points2[j] = roadmap[j].position;
+			}
+
+			sim->queryVisibility(points1, points2, visible, sim->getAgentRadius(i));
 
-				minDist = RVO::abs(roadmap[j].position - sim->getAgentPosition(i)) + roadmap[j].distToGoal[goals[i]];
-				minVertex = j;
+			float minDist = 9e9f;
+			waypoints[i] = -1;
+			waypointRegions[i] = region;
+
+			for (int j = 0; j < static_cast<int>(roadmap.size()); ++j) {
+				if (visible[j] && RVO::abs(roadmap[j].position - position) + roadmap[j].distToGoal[goals[i]] < minDist) {
+					minDist = RVO::abs(roadmap[j].position - position) + roadmap[j].distToGoal[goals[i]];
+					waypoints[i] = j;
+				}
 			}
 		}
 
+		const int minVertex = waypoints[i];
+
 		if (minVertex == -1) {
 			/* No roadmap vertex is visible; should not happen. */
 			sim->setAgentPrefVelocity(i, RVO::Vector2(0, 0));
@@ -352,6 +394,10 @@ int main(int argc, const char *argv[])
 	/* Build the roadmap. */
 	buildRoadmap(sim);
 
+	/* No agent has chosen a waypoint yet. */
+	waypoints.assign(sim->getNumAgents(), -1);
+	waypointRegions.resize(sim->getNumAgents());
+
 	/* Perform (and manipulate) the simulation. */
 	do {
 		updateVisualization(sim);
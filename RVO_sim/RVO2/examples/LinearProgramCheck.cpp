@@ -0,0 +1,303 @@
+/*
+ * LinearProgramCheck.cpp
+ * RVO2 Library
+ *
+ * Copyright (c) 2008-2010 University of North Carolina at Chapel Hill.
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation for educational, research, and non-profit purposes, without
+ * fee, and without a written agreement is hereby granted, provided that the
+ * above copyright notice, this paragraph, and the following four paragraphs
+ * appear in all copies.
+ */
+
+/*
+ * Checks and times the linear programs that compute the new velocities.
+ *
+ * "dump" simulates 400 agents split in four groups crossing through the narrow
+ * passage of ExampleBlocks, and writes the ORCA lines, preferred velocity and
+ * resulting velocity of every constrained agent on every fifth step. These
+ * velocities come from the grouped SSE2 solver when the library is built with
+ * it.
+ *
+ * "replay" solves each dumped program again with linearProgram2 and
+ * linearProgram3, and fails if any velocity differs from the dumped one by
+ * more than a tolerance. Linked with libRVOs.a, which is built with
+ * RVO_SCALAR, this checks the SSE2 kernels against the scalar path.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "RVO.h"
+#include "Agent.h"
+
+/* Largest allowed difference between two velocities of the same program. */
+const float MAX_DIFFERENCE = 0.001f;
+
+/* Number of times the programs are solved when timing them. */
+const size_t NUM_REPEATS = 20;
+
+/* Store the goals of the agents. */
+std::vector<RVO::Vector2> goals;
+
+/* A dumped linear program and the velocity the simulator found for it. */
+struct Program {
+	size_t numObstLines;
+	RVO::Real maxSpeed;
+	RVO::Vector2 prefVelocity;
+	RVO::Vector2 velocity;
+	std::vector<RVO::Line> lines;
+};
+
+void setupScenario(RVO::RVOSimulator *sim)
+{
+	/* Seed the random number generator, the same on every run. */
+	std::srand(0);
+
+	sim->setTimeStep(0.25f);
+	sim->setAgentDefaults(10.0f, 10, 5.0f, 5.0f, 1.0f, 2.0f);
+
+	/* Tightly packed groups in the four corners, headed for the opposite ones. */
+	for (size_t i = 0; i < 10; ++i) {
+		for (size_t j = 0; j < 10; ++j) {
+			sim->addAgent(RVO::Vector2(50.0f + i * 2.5f,  50.0f + j * 2.5f));
+			goals.push_back(RVO::Vector2(-75.0f, -75.0f));
+
+			sim->addAgent(RVO::Vector2(-50.0f - i * 2.5f,  50.0f + j * 2.5f));
+			goals.push_back(RVO::Vector2(75.0f, -75.0f));
+
+			sim->addAgent(RVO::Vector2(50.0f + i * 2.5f, -50.0f - j * 2.5f));
+			goals.push_back(RVO::Vector2(-75.0f, 75.0f));
+
+			sim->addAgent(RVO::Vector2(-50.0f - i * 2.5f, -50.0f - j * 2.5f));
+			goals.push_back(RVO::Vector2(75.0f, 75.0f));
+		}
+	}
+
+	std::vector<RVO::Vector2> obstacle1, obstacle2, obstacle3, obstacle4;
+
+	obstacle1.push_back(RVO::Vector2(-10.0f, 40.0f));
+	obstacle1.push_back(RVO::Vector2(-40.0f, 40.0f));
+	obstacle1.push_back(RVO::Vector2(-40.0f, 10.0f));
+	obstacle1.push_back(RVO::Vector2(-10.0f, 10.0f));
+
+	obstacle2.push_back(RVO::Vector2(10.0f, 40.0f));
+	obstacle2.push_back(RVO::Vector2(10.0f, 10.0f));
+	obstacle2.push_back(RVO::Vector2(40.0f, 10.0f));
+	obstacle2.push_back(RVO::Vector2(40.0f, 40.0f));
+
+	obstacle3.push_back(RVO::Vector2(10.0f, -40.0f));
+	obstacle3.push_back(RVO::Vector2(40.0f, -40.0f));
+	obstacle3.push_back(RVO::Vector2(40.0f, -10.0f));
+	obstacle3.push_back(RVO::Vector2(10.0f, -10.0f));
+
+	obstacle4.push_back(RVO::Vector2(-10.0f, -40.0f));
+	obstacle4.push_back(RVO::Vector2(-10.0f, -10.0f));
+	obstacle4.push_back(RVO::Vector2(-40.0f, -10.0f));
+	obstacle4.push_back(RVO::Vector2(-40.0f, -40.0f));
+
+	sim->addObstacle(obstacle1);
+	sim->addObstacle(obstacle2);
+	sim->addObstacle(obstacle3);
+	sim->addObstacle(obstacle4);
+
+	sim->processObstacles();
+}
+
+void setPreferredVelocities(RVO::RVOSimulator *sim)
+{
+	for (size_t i = 0; i < sim->getNumAgents(); ++i) {
+		RVO::Vector2 goalVector = goals[i] - sim->getAgentPosition(i);
+
+		if (RVO::absSq(goalVector) > 1.0f) {
+			goalVector = RVO::normalize(goalVector);
+		}
+
+		/* Perturb a little to avoid deadlocks due to perfect symmetry. */
+		float angle = std::rand() * 2.0f * static_cast<float>(M_PI) / RAND_MAX;
+		float dist = std::rand() * 0.0001f / RAND_MAX;
+
+		sim->setAgentPrefVelocity(i, goalVector + dist * RVO::Vector2(std::cos(angle), std::sin(angle)));
+	}
+}
+
+int dumpPrograms(const char *filename)
+{
+	std::ofstream file(filename);
+
+	if (!file.is_open()) {
+		std::cerr << "Unable to write " << filename << std::endl;
+		return 1;
+	}
+
+	file.precision(std::numeric_limits<RVO::Real>::digits10 + 3);
+
+	RVO::RVOSimulator *sim = new RVO::RVOSimulator();
+	setupScenario(sim);
+
+	size_t numPrograms = 0;
+
+	for (size_t step = 0; step < 400; ++step) {
+		setPreferredVelocities(sim);
+		sim->doStep();
+
+		if (step % 5 != 0) {
+			continue;
+		}
+
+		/* The ORCA lines of the step just taken, and the velocities found from them. */
+		for (size_t i = 0; i < sim->getNumAgents(); ++i) {
+			const size_t numLines = sim->getAgentNumORCALines(i);
+
+			if (numLines == 0) {
+				continue;
+			}
+
+			const RVO::Vector2 &prefVelocity = sim->getAgentPrefVelocity(i);
+			const RVO::Vector2 &velocity = sim->getAgentVelocity(i);
+
+			file << numLines << " " << sim->getAgentNumObstacleORCALines(i) << " " << sim->getAgentMaxSpeed(i) << " "
+				 << prefVelocity.x() << " " << prefVelocity.y() << " " << velocity.x() << " " << velocity.y() << "\n";
+
+			for (size_t j = 0; j < numLines; ++j) {
+				const RVO::Line &line = sim->getAgentORCALine(i, j);
+
+				file << line.direction.x() << " " << line.direction.y() << " " << line.point.x() << " " << line.point.y() << "\n";
+			}
+
+			++numPrograms;
+		}
+	}
+
+	delete sim;
+
+	std::cout << "Dumped " << numPrograms << " linear programs to " << filename << std::endl;
+
+	return 0;
+}
+
+int readPrograms(const char *filename, std::vector<Program> &programs)
+{
+	std::ifstream file(filename);
+
+	if (!file.is_open()) {
+		std::cerr << "Unable to read " << filename << std::endl;
+		return 1;
+	}
+
+	size_t numLines;
+
+	while (file >> numLines) {
+		Program program;
+		RVO::Real prefX, prefY, velocityX, velocityY;
+
+		file >> program.numObstLines >> program.maxSpeed >> prefX >> prefY >> velocityX >> velocityY;
+		program.prefVelocity = RVO::Vector2(prefX, prefY);
+		program.velocity = RVO::Vector2(velocityX, velocityY);
+
+		for (size_t j = 0; j < numLines; ++j) {
+			RVO::Real directionX, directionY, pointX, pointY;
+			RVO::Line line;
+
+			file >> directionX >> directionY >> pointX >> pointY;
+			line.direction = RVO::Vector2(directionX, directionY);
+			line.point = RVO::Vector2(pointX, pointY);
+			program.lines.push_back(line);
+		}
+
+		if (!file) {
+			std::cerr << "Corrupt program " << programs.size() << " in " << filename << std::endl;
+			return 1;
+		}
+
+		programs.push_back(program);
+	}
+
+	return 0;
+}
+
+/* Solve a program as Agent::computeNewVelocity does. */
+RVO::Vector2 solveProgram(const Program &program, RVO::LineSet &lines, RVO::LineSet &projLines)
+{
+	RVO::Vector2 result;
+
+	lines.assign(program.lines);
+
+	size_t lineFail = RVO::linearProgram2(lines, program.maxSpeed, program.prefVelocity, false, result);
+
+	if (lineFail < lines.size()) {
+		RVO::linearProgram3(lines, program.numObstLines, lineFail, program.maxSpeed, result, projLines);
+	}
+
+	return result;
+}
+
+int replayPrograms(const char *filename)
+{
+	std::vector<Program> programs;
+
+	if (readPrograms(filename, programs)) {
+		return 1;
+	}
+
+	RVO::LineSet lines;
+	RVO::LineSet projLines;
+	size_t numFailed = 0;
+	RVO::Real maxDifference = 0.0f;
+
+	for (size_t k = 0; k < programs.size(); ++k) {
+		const RVO::Real difference = RVO::abs(solveProgram(programs[k], lines, projLines) - programs[k].velocity);
+
+		maxDifference = std::max(maxDifference, difference);
+
+		if (!(difference <= MAX_DIFFERENCE)) {
+			++numFailed;
+		}
+	}
+
+	/* Time the programs. */
+	const std::clock_t start = std::clock();
+
+	for (size_t repeat = 0; repeat < NUM_REPEATS; ++repeat) {
+		for (size_t k = 0; k < programs.size(); ++k) {
+			solveProgram(programs[k], lines, projLines);
+		}
+	}
+
+	const double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+
+#ifdef RVO_SSE2
+	std::cout << "SSE2";
+#else
+	std::cout << "Scalar";
+#endif
+	std::cout << " path: " << programs.size() << " programs, " << numFailed << " differ by more than " << MAX_DIFFERENCE
+			  << " (largest difference " << maxDifference << "), "
+			  << (programs.empty() ? 0.0 : 1.0e9 * seconds / (NUM_REPEATS * programs.size())) << " ns per program" << std::endl;
+
+	return (numFailed == 0 ? 0 : 1);
+}
+
+int main(int argc, const char *argv[])
+{
+	const std::string mode = (argc == 3 ? argv[1] : "");
+
+	if (mode == "dump") {
+		return dumpPrograms(argv[2]);
+	}
+	else if (mode == "replay") {
+		return replayPrograms(argv[2]);
+	}
+
+	std::cerr << "Usage: " << argv[0] << " dump|replay <ProgramsFile>" << std::endl;
+
+	return 1;
+}
@@ -55,33 +55,134 @@
  */
 
 #include "Agent.h"
+#include "AgentGrid.h"
 
 #include "KdTree.h"
 #include "Obstacle.h"
 
+#ifdef RVO_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace RVO {
-	Agent::Agent(RVOSimulator *sim) : maxNeighbors_(0), maxSpeed_(0.0f), neighborDist_(0.0f), radius_(0.0f), sim_(sim), timeHorizon_(0.0f), timeHorizonObst_(0.0f), id_(0) { }
+	Agent::Agent(RVOSimulator *sim) : agentCandidateRangeSq_(0.0f), dormant_(false), freeFlightSteps_(0), lowDetail_(false), maxNeighbors_(0), maxSpeed_(0.0f), neighborDist_(0.0f), numObstLines_(0), radius_(0.0f), sim_(sim), timeHorizon_(0.0f), timeHorizonObst_(0.0f), id_(0) { }
 
 	void Agent::computeNeighbors()
 	{
-		obstacleNeighbors_.clear();
-		float rangeSq = sqr(timeHorizonObst_ * maxSpeed_ + radius_);
+		if (sim_->neighborSkin_ > 0.0f) {
+			computeNeighborsFromCandidates();
+			return;
+		}
+
+		/* A fresh search ends any free flight; it is only restarted if the search comes up empty. */
+		freeFlightSteps_ = 0;
+
+		obstacleNeighbors_.reset();
+		Real rangeSq = sqr(timeHorizonObst_ * maxSpeed_ + radius_);
 		sim_->kdTree_->computeObstacleNeighbors(this, rangeSq);
 
-		agentNeighbors_.clear();
+		agentNeighbors_.reset(maxNeighbors_);
 
 		if (maxNeighbors_ > 0) {
 			rangeSq = sqr(neighborDist_);
 			sim_->kdTree_->computeAgentNeighbors(this, rangeSq);
 		}
+
+		if (agentNeighbors_.size() == 0 && obstacleNeighbors_.size() == 0) {
+			computeFreeFlightSteps();
+		}
 	}
 
-	/* Search for the best new velocity. */
-	void Agent::computeNewVelocity()
+	void Agent::computeFreeFlightSteps()
+	{
+		const Real margin = neighborDist_;
+
+		freeFlightSteps_ = 0;
+
+		obstacleCandidates_.clear();
+		sim_->kdTree_->computeObstacleCandidates(this, sqr(timeHorizonObst_ * maxSpeed_ + radius_ + margin));
+
+		agentCandidates_.clear();
+
+		if (maxNeighbors_ > 0) {
+			sim_->kdTree_->computeAgentCandidates(this, sqr(neighborDist_ + margin));
+		}
+
+		const Real maxStep = (maxSpeed_ + sim_->maxAgentSpeed_) * sim_->timeStep_;
+
+		if (obstacleCandidates_.empty() && agentCandidates_.empty() && maxStep > 0.0f) {
+			/* One step less than the bound, against rounding. */
+			const Real steps = margin / maxStep;
+			freeFlightSteps_ = (steps >= 2.0f ? static_cast<size_t>(steps) - 1 : 0);
+		}
+
+		obstacleCandidates_.clear();
+		agentCandidates_.clear();
+	}
+
+	void Agent::computeNeighborsFromCandidates()
+	{
+		const Real obstacleRange = timeHorizonObst_ * maxSpeed_ + radius_;
+
+		if (sim_->rebuildNeighborLists_) {
+			obstacleCandidates_.clear();
+			sim_->kdTree_->computeObstacleCandidates(this, sqr(obstacleRange + sim_->neighborSkin_));
+
+			agentCandidates_.clear();
+
+			if (maxNeighbors_ > 0) {
+				/*
+				 * Until the lists are rebuilt, the nearest agents now stay within
+				 * their present distance plus the skin, so no agent farther than
+				 * that plus the skin again can become a neighbor.
+				 */
+				Real rangeSq = sqr(neighborDist_);
+				agentNeighbors_.reset(maxNeighbors_);
+				sim_->kdTree_->computeAgentNeighbors(this, rangeSq);
+
+				agentCandidateRangeSq_ = sqr(std::min(neighborDist_, std::sqrt(rangeSq) + sim_->neighborSkin_) + sim_->neighborSkin_);
+				sim_->kdTree_->computeAgentCandidates(this, agentCandidateRangeSq_);
+			}
+		}
+
+		const Vector2 &position = sim_->agentPositions_[id_];
+
+		obstacleNeighbors_.reset();
+		Real rangeSq = sqr(obstacleRange);
+
+		for (size_t i = 0; i < obstacleCandidates_.size(); ++i) {
+			const Obstacle *const obstacle = obstacleCandidates_[i];
+
+			/* Only obstacles the agent is on the right side of are neighbors. */
+			if (leftOf(obstacle->point_, obstacle->nextObstacle_->point_, position) < 0.0f) {
+				insertObstacleNeighbor(obstacle, rangeSq);
+			}
+		}
+
+		agentNeighbors_.reset(maxNeighbors_);
+
+		if (maxNeighbors_ > 0) {
+			rangeSq = sqr(neighborDist_);
+
+			for (size_t i = 0; i < agentCandidates_.size(); ++i) {
+				const Agent *const other = agentCandidates_[i];
+				const Real distSq = absSq(position - sim_->agentPositions_[other->id_]);
+
+				if (distSq < rangeSq) {
+					insertAgentNeighbor(other, distSq, rangeSq);
+				}
+			}
+		}
+	}
+
+	void Agent::computeORCALines()
 	{
+		const Vector2 &position = sim_->agentPositions_[id_];
+		const Vector2 &velocity = sim_->agentVelocities_[id_];
+
 		orcaLines_.clear();
 
-		const float invTimeHorizonObst = 1.0f / timeHorizonObst_;
+		const Real invTimeHorizonObst = 1.0f / timeHorizonObst_;
 
 		/* Create obstacle ORCA lines. */
 		for (size_t i = 0; i < obstacleNeighbors_.size(); ++i) {
@@ -89,8 +190,8 @@ namespace RVO {
 			const Obstacle *obstacle1 = obstacleNeighbors_[i].second;
 			const Obstacle *obstacle2 = obstacle1->nextObstacle_;
 
-			const Vector2 relativePosition1 = obstacle1->point_ - position_;
-			const Vector2 relativePosition2 = obstacle2->point_ - position_;
+			const Vector2 relativePosition1 = obstacle1->point_ - position;
+			const Vector2 relativePosition2 = obstacle2->point_ - position;
 
 			/*
 			 * Check if velocity obstacle of obstacle is already taken care of by
@@ -111,14 +212,14 @@ namespace RVO {
 
 			/* Not yet covered. Check for collisions. */
 
-			const float distSq1 = absSq(relativePosition1);
-			const float distSq2 = absSq(relativePosition2);
+			const Real distSq1 = absSq(relativePosition1);
+			const Real distSq2 = absSq(relativePosition2);
 
-			const float radiusSq = sqr(radius_);
+			const Real radiusSq = sqr(radius_);
 
 			const Vector2 obstacleVector = obstacle2->point_ - obstacle1->point_;
-			const float s = (-relativePosition1 * obstacleVector) / absSq(obstacleVector);
-			const float distSqLine = absSq(-relativePosition1 - s * obstacleVector);
+			const Real s = (-relativePosition1 * obstacleVector) / absSq(obstacleVector);
+			const Real distSqLine = absSq(-relativePosition1 - s * obstacleVector);
 
 			Line line;
 
@@ -171,7 +272,7 @@ namespace RVO {
 
 				obstacle2 = obstacle1;
 
-				const float leg1 = std::sqrt(distSq1 - radiusSq);
+				const Real leg1 = std::sqrt(distSq1 - radiusSq);
 				leftLegDirection = Vector2(relativePosition1.x() * leg1 - relativePosition1.y() * radius_, relativePosition1.x() * radius_ + relativePosition1.y() * leg1) / distSq1;
 				rightLegDirection = Vector2(relativePosition1.x() * leg1 + relativePosition1.y() * radius_, -relativePosition1.x() * radius_ + relativePosition1.y() * leg1) / distSq1;
 			}
@@ -187,14 +288,14 @@ namespace RVO {
 
 				obstacle1 = obstacle2;
 
-				const float leg2 = std::sqrt(distSq2 - radiusSq);
+				const Real leg2 = std::sqrt(distSq2 - radiusSq);
 				leftLegDirection = Vector2(relativePosition2.x() * leg2 - relativePosition2.y() * radius_, relativePosition2.x() * radius_ + relativePosition2.y() * leg2) / distSq2;
 				rightLegDirection = Vector2(relativePosition2.x() * leg2 + relativePosition2.y() * radius_, -relativePosition2.x() * radius_ + relativePosition2.y() * leg2) / distSq2;
 			}
 			else {
 				/* Usual situation. */
 				if (obstacle1->isConvex_) {
-					const float leg1 = std::sqrt(distSq1 - radiusSq);
+					const Real leg1 = std::sqrt(distSq1 - radiusSq);
 					leftLegDirection = Vector2(relativePosition1.x() * leg1 - relativePosition1.y() * radius_, relativePosition1.x() * radius_ + relativePosition1.y() * leg1) / distSq1;
 				}
 				else {
@@ -203,7 +304,7 @@ namespace RVO {
 				}
 
 				if (obstacle2->isConvex_) {
-					const float leg2 = std::sqrt(distSq2 - radiusSq);
+					const Real leg2 = std::sqrt(distSq2 - radiusSq);
 					rightLegDirection = Vector2(relativePosition2.x() * leg2 + relativePosition2.y() * radius_, -relativePosition2.x() * radius_ + relativePosition2.y() * leg2) / distSq2;
 				}
 				else {
@@ -236,20 +337,20 @@ namespace RVO {
 			}
 
 			/* Compute cut-off centers. */
-			const Vector2 leftCutoff = invTimeHorizonObst * (obstacle1->point_ - position_);
-			const Vector2 rightCutoff = invTimeHorizonObst * (obstacle2->point_ - position_);
+			const Vector2 leftCutoff = invTimeHorizonObst * (obstacle1->point_ - position);
+			const Vector2 rightCutoff = invTimeHorizonObst * (obstacle2->point_ - position);
 			const Vector2 cutoffVec = rightCutoff - leftCutoff;
 
 			/* Project current velocity on velocity obstacle. */
 
 			/* Check if current velocity is projected on cutoff circles. */
-			const float t = (obstacle1 == obstacle2 ? 0.5f : ((velocity_ - leftCutoff) * cutoffVec) / absSq(cutoffVec));
-			const float tLeft = ((velocity_ - leftCutoff) * leftLegDirection);
-			const float tRight = ((velocity_ - rightCutoff) * rightLegDirection);
+			const Real t = (obstacle1 == obstacle2 ? 0.5f : ((velocity - leftCutoff) * cutoffVec) / absSq(cutoffVec));
+			const Real tLeft = ((velocity - leftCutoff) * leftLegDirection);
+			const Real tRight = ((velocity - rightCutoff) * rightLegDirection);
 
 			if ((t < 0.0f && tLeft < 0.0f) || (obstacle1 == obstacle2 && tLeft < 0.0f && tRight < 0.0f)) {
 				/* Project on left cut-off circle. */
-				const Vector2 unitW = normalize(velocity_ - leftCutoff);
+				const Vector2 unitW = normalize(velocity - leftCutoff);
 
 				line.direction = Vector2(unitW.y(), -unitW.x());
 				line.point = leftCutoff + radius_ * invTimeHorizonObst * unitW;
@@ -258,7 +359,7 @@ namespace RVO {
 			}
 			else if (t > 1.0f && tRight < 0.0f) {
 				/* Project on right cut-off circle. */
-				const Vector2 unitW = normalize(velocity_ - rightCutoff);
+				const Vector2 unitW = normalize(velocity - rightCutoff);
 
 				line.direction = Vector2(unitW.y(), -unitW.x());
 				line.point = rightCutoff + radius_ * invTimeHorizonObst * unitW;
@@ -270,9 +371,9 @@ namespace RVO {
 			 * Project on left leg, right leg, or cut-off line, whichever is closest
 			 * to velocity.
 			 */
-			const float distSqCutoff = ((t < 0.0f || t > 1.0f || obstacle1 == obstacle2) ? std::numeric_limits<float>::infinity() : absSq(velocity_ - (leftCutoff + t * cutoffVec)));
-			const float distSqLeft = ((tLeft < 0.0f) ? std::numeric_limits<float>::infinity() : absSq(velocity_ - (leftCutoff + tLeft * leftLegDirection)));
-			const float distSqRight = ((tRight < 0.0f) ? std::numeric_limits<float>::infinity() : absSq(velocity_ - (rightCutoff + tRight * rightLegDirection)));
+			const Real distSqCutoff = ((t < 0.0f || t > 1.0f || obstacle1 == obstacle2) ? std::numeric_limits<Real>::infinity() : absSq(velocity - (leftCutoff + t * cutoffVec)));
+			const Real distSqLeft = ((tLeft < 0.0f) ? std::numeric_limits<Real>::infinity() : absSq(velocity - (leftCutoff + tLeft * leftLegDirection)));
+			const Real distSqRight = ((tRight < 0.0f) ? std::numeric_limits<Real>::infinity() : absSq(velocity - (rightCutoff + tRight * rightLegDirection)));
 
 			if (distSqCutoff <= distSqLeft && distSqCutoff <= distSqRight) {
 				/* Project on cut-off line. */
@@ -305,19 +406,19 @@ namespace RVO {
 			}
 		}
 
-		const size_t numObstLines = orcaLines_.size();
+		numObstLines_ = orcaLines_.size();
 
-		const float invTimeHorizon = 1.0f / timeHorizon_;
+		const Real invTimeHorizon = 1.0f / timeHorizon_;
 
 		/* Create agent ORCA lines. */
 		for (size_t i = 0; i < agentNeighbors_.size(); ++i) {
 			const Agent *const other = agentNeighbors_[i].second;
 
-			const Vector2 relativePosition = other->position_ - position_;
-			const Vector2 relativeVelocity = velocity_ - other->velocity_;
-			const float distSq = absSq(relativePosition);
-			const float combinedRadius = radius_ + other->radius_;
-			const float combinedRadiusSq = sqr(combinedRadius);
+			const Vector2 relativePosition = sim_->agentPositions_[other->id_] - position;
+			const Vector2 relativeVelocity = velocity - sim_->agentVelocities_[other->id_];
+			const Real distSq = absSq(relativePosition);
+			const Real combinedRadius = radius_ + other->radius_;
+			const Real combinedRadiusSq = sqr(combinedRadius);
 
 			Line line;
 			Vector2 u;
@@ -326,13 +427,13 @@ namespace RVO {
 				/* No collision. */
 				const Vector2 w = relativeVelocity - invTimeHorizon * relativePosition;
 				/* Vector from cutoff center to relative velocity. */
-				const float wLengthSq = absSq(w);
+				const Real wLengthSq = absSq(w);
 
-				const float dotProduct1 = w * relativePosition;
+				const Real dotProduct1 = w * relativePosition;
 
 				if (dotProduct1 < 0.0f && sqr(dotProduct1) > combinedRadiusSq * wLengthSq) {
 					/* Project on cut-off circle. */
-					const float wLength = std::sqrt(wLengthSq);
+					const Real wLength = std::sqrt(wLengthSq);
 					const Vector2 unitW = w / wLength;
 
 					line.direction = Vector2(unitW.y(), -unitW.x());
@@ -340,7 +441,7 @@ namespace RVO {
 				}
 				else {
 					/* Project on legs. */
-					const float leg = std::sqrt(distSq - combinedRadiusSq);
+					const Real leg = std::sqrt(distSq - combinedRadiusSq);
 
 					if (det(relativePosition, w) > 0.0f) {
 						/* Project on left leg. */
@@ -351,105 +452,434 @@ namespace RVO {
 						line.direction = -Vector2(relativePosition.x() * leg + relativePosition.y() * combinedRadius, -relativePosition.x() * combinedRadius + relativePosition.y() * leg) / distSq;
 					}
 
-					const float dotProduct2 = relativeVelocity * line.direction;
+					const Real dotProduct2 = relativeVelocity * line.direction;
 
 					u = dotProduct2 * line.direction - relativeVelocity;
 				}
 			}
 			else {
 				/* Collision. Project on cut-off circle of time timeStep. */
-				const float invTimeStep = 1.0f / sim_->timeStep_;
+				const Real invTimeStep = 1.0f / sim_->timeStep_;
 
 				/* Vector from cutoff center to relative velocity. */
 				const Vector2 w = relativeVelocity - invTimeStep * relativePosition;
 
-				const float wLength = abs(w);
+				const Real wLength = abs(w);
 				const Vector2 unitW = w / wLength;
 
 				line.direction = Vector2(unitW.y(), -unitW.x());
 				u = (combinedRadius * invTimeStep - wLength) * unitW;
 			}
 
-			line.point = velocity_ + 0.5f * u;
+			/* Dormant agents do not move aside, so the whole avoidance is taken here. */
+			line.point = velocity + (other->dormant_ ? 1.0f : 0.5f) * u;
 			orcaLines_.push_back(line);
 		}
+	}
 
-		size_t lineFail = linearProgram2(orcaLines_, maxSpeed_, prefVelocity_, false, newVelocity_);
+	/* Search for the best new velocity. */
+	void Agent::computeNewVelocity(LinearProgramScratch &scratch)
+	{
+		Vector2 &newVelocity = sim_->agentNewVelocities_[id_];
 
-		if (lineFail < orcaLines_.size()) {
-			linearProgram3(orcaLines_, numObstLines, lineFail, maxSpeed_, newVelocity_);
+		scratch.orcaLines.assign(orcaLines_);
+
+		size_t lineFail = linearProgram2(scratch.orcaLines, maxSpeed_, sim_->agentPrefVelocities_[id_], false, newVelocity);
+
+		if (lineFail < scratch.orcaLines.size()) {
+			linearProgram3(scratch.orcaLines, numObstLines_, lineFail, maxSpeed_, newVelocity, scratch.projLines);
 		}
 	}
 
-	void Agent::insertAgentNeighbor(const Agent *agent, float &rangeSq)
+	void Agent::computeNewVelocities(Agent *const *agents, size_t numAgents, LinearProgramScratch &scratch)
 	{
-		if (this != agent) {
-			const float distSq = absSq(position_ - agent->position_);
+#ifdef RVO_SSE2
+		size_t numLines = 0;
+
+		for (size_t k = 0; k < numAgents; ++k) {
+			numLines = std::max(numLines, agents[k]->orcaLines_.size());
+		}
+
+		if (scratch.groupLines.size() < 16 * numLines) {
+			scratch.groupLines.resize(16 * numLines);
+		}
 
-			if (distSq < rangeSq) {
-				if (agentNeighbors_.size() < maxNeighbors_) {
-					agentNeighbors_.push_back(std::make_pair(distSq, agent));
+		/*
+		 * Interleave the ORCA lines of the agents so that line i of agent k is
+		 * in lane k of the four vectors starting at 16 * i. Missing lines and
+		 * missing agents are padded with zero lines, which are never violated
+		 * and never bound another line.
+		 */
+		Real radii[4];
+		Real optVelocitiesX[4];
+		Real optVelocitiesY[4];
+		Real resultsX[4];
+		Real resultsY[4];
+		size_t lineFails[4];
+
+		for (size_t k = 0; k < 4; ++k) {
+			const size_t agentLines = (k < numAgents ? agents[k]->orcaLines_.size() : 0);
+
+			for (size_t i = 0; i < numLines; ++i) {
+				Real *const line = &scratch.groupLines[16 * i];
+
+				if (i < agentLines) {
+					const Line &orcaLine = agents[k]->orcaLines_[i];
+					line[k] = orcaLine.direction.x();
+					line[4 + k] = orcaLine.direction.y();
+					line[8 + k] = orcaLine.point.x();
+					line[12 + k] = orcaLine.point.y();
+				}
+				else {
+					line[k] = line[4 + k] = line[8 + k] = line[12 + k] = 0.0f;
 				}
+			}
+
+			Vector2 optVelocity;
+			Vector2 result;
+			Real radius = 0.0f;
+
+			if (k < numAgents) {
+				optVelocity = agents[k]->sim_->agentPrefVelocities_[agents[k]->id_];
+				radius = agents[k]->maxSpeed_;
+
+				/* Same starting point as linearProgram2 when optimizing the closest point. */
+				if (absSq(optVelocity) > sqr(radius)) {
+					result = normalize(optVelocity) * radius;
+				}
+				else {
+					result = optVelocity;
+				}
+			}
+
+			radii[k] = radius;
+			optVelocitiesX[k] = optVelocity.x();
+			optVelocitiesY[k] = optVelocity.y();
+			resultsX[k] = result.x();
+			resultsY[k] = result.y();
+			lineFails[k] = agentLines;
+		}
+
+		const __m128 optX = _mm_loadu_ps(optVelocitiesX);
+		const __m128 optY = _mm_loadu_ps(optVelocitiesY);
+		const __m128 radiiSq = _mm_mul_ps(_mm_loadu_ps(radii), _mm_loadu_ps(radii));
+		const __m128 epsilon = _mm_set1_ps(RVO_EPSILON);
+		const __m128 signBit = _mm_set1_ps(-0.0f);
+		const __m128 zero = _mm_setzero_ps();
+
+		__m128 resultX = _mm_loadu_ps(resultsX);
+		__m128 resultY = _mm_loadu_ps(resultsY);
+		__m128 failed = zero;
+
+		/* Incremental two-dimensional linear program, one agent per lane. */
+		for (size_t i = 0; i < numLines; ++i) {
+			const Real *const line = &scratch.groupLines[16 * i];
+			const __m128 directionX = _mm_loadu_ps(line);
+			const __m128 directionY = _mm_loadu_ps(line + 4);
+			const __m128 pointX = _mm_loadu_ps(line + 8);
+			const __m128 pointY = _mm_loadu_ps(line + 12);
+
+			const __m128 violated = _mm_andnot_ps(failed, _mm_cmpgt_ps(_mm_sub_ps(_mm_mul_ps(directionX, _mm_sub_ps(pointY, resultY)), _mm_mul_ps(directionY, _mm_sub_ps(pointX, resultX))), zero));
+
+			if (_mm_movemask_ps(violated) == 0) {
+				continue;
+			}
+
+			/* One-dimensional linear program on line i, as in linearProgram1. */
+			const __m128 dotProduct = _mm_add_ps(_mm_mul_ps(pointX, directionX), _mm_mul_ps(pointY, directionY));
+			const __m128 discriminant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(dotProduct, dotProduct), radiiSq), _mm_add_ps(_mm_mul_ps(pointX, pointX), _mm_mul_ps(pointY, pointY)));
+			const __m128 sqrtDiscriminant = _mm_sqrt_ps(discriminant);
+			const __m128 negDotProduct = _mm_xor_ps(dotProduct, signBit);
+
+			__m128 infeasible = _mm_cmplt_ps(discriminant, zero);
+			__m128 lefts = _mm_sub_ps(negDotProduct, sqrtDiscriminant);
+			__m128 rights = _mm_add_ps(negDotProduct, sqrtDiscriminant);
+
+			for (size_t j = 0; j < i; ++j) {
+				const Real *const other = &scratch.groupLines[16 * j];
+				const __m128 otherDirectionX = _mm_loadu_ps(other);
+				const __m128 otherDirectionY = _mm_loadu_ps(other + 4);
+
+				const __m128 denominators = _mm_sub_ps(_mm_mul_ps(directionX, otherDirectionY), _mm_mul_ps(directionY, otherDirectionX));
+				const __m128 numerators = _mm_sub_ps(_mm_mul_ps(otherDirectionX, _mm_sub_ps(pointY, _mm_loadu_ps(other + 12))), _mm_mul_ps(otherDirectionY, _mm_sub_ps(pointX, _mm_loadu_ps(other + 8))));
+
+				const __m128 parallel = _mm_cmple_ps(_mm_andnot_ps(signBit, denominators), epsilon);
+				infeasible = _mm_or_ps(infeasible, _mm_and_ps(parallel, _mm_cmplt_ps(numerators, zero)));
+
+				const __m128 t = _mm_div_ps(numerators, denominators);
+				const __m128 boundsRight = _mm_andnot_ps(parallel, _mm_cmpge_ps(denominators, zero));
+				const __m128 boundsLeft = _mm_andnot_ps(parallel, _mm_cmplt_ps(denominators, zero));
+
+				rights = _mm_or_ps(_mm_and_ps(boundsRight, _mm_min_ps(t, rights)), _mm_andnot_ps(boundsRight, rights));
+				lefts = _mm_or_ps(_mm_and_ps(boundsLeft, _mm_max_ps(t, lefts)), _mm_andnot_ps(boundsLeft, lefts));
+			}
+
+			infeasible = _mm_or_ps(infeasible, _mm_cmpgt_ps(lefts, rights));
+
+			/* Optimize closest point. */
+			__m128 t = _mm_add_ps(_mm_mul_ps(directionX, _mm_sub_ps(optX, pointX)), _mm_mul_ps(directionY, _mm_sub_ps(optY, pointY)));
+			const __m128 belowLeft = _mm_cmplt_ps(t, lefts);
+			const __m128 aboveRight = _mm_andnot_ps(belowLeft, _mm_cmpgt_ps(t, rights));
+			t = _mm_or_ps(_mm_and_ps(belowLeft, lefts), _mm_andnot_ps(belowLeft, t));
+			t = _mm_or_ps(_mm_and_ps(aboveRight, rights), _mm_andnot_ps(aboveRight, t));
+
+			const __m128 solved = _mm_andnot_ps(infeasible, violated);
+			resultX = _mm_or_ps(_mm_and_ps(solved, _mm_add_ps(pointX, _mm_mul_ps(t, directionX))), _mm_andnot_ps(solved, resultX));
+			resultY = _mm_or_ps(_mm_and_ps(solved, _mm_add_ps(pointY, _mm_mul_ps(t, directionY))), _mm_andnot_ps(solved, resultY));
+
+			const int newFails = _mm_movemask_ps(_mm_and_ps(violated, infeasible));
 
-				size_t i = agentNeighbors_.size() - 1;
+			if (newFails != 0) {
+				failed = _mm_or_ps(failed, _mm_and_ps(violated, infeasible));
 
-				while (i != 0 && distSq < agentNeighbors_[i - 1].first) {
-					agentNeighbors_[i] = agentNeighbors_[i - 1];
-					--i;
+				for (size_t k = 0; k < 4; ++k) {
+					if ((newFails & (1 << k)) != 0) {
+						lineFails[k] = i;
+					}
 				}
+			}
+		}
+
+		_mm_storeu_ps(resultsX, resultX);
+		_mm_storeu_ps(resultsY, resultY);
+
+		for (size_t k = 0; k < numAgents; ++k) {
+			Agent *const agent = agents[k];
+			Vector2 &newVelocity = agent->sim_->agentNewVelocities_[agent->id_];
+
+			newVelocity = Vector2(resultsX[k], resultsY[k]);
+
+			if (lineFails[k] < agent->orcaLines_.size()) {
+				/* Lanes where the two-dimensional program fails drop out to the scalar path. */
+				scratch.orcaLines.assign(agent->orcaLines_);
+				linearProgram3(scratch.orcaLines, agent->numObstLines_, lineFails[k], agent->maxSpeed_, newVelocity, scratch.projLines);
+			}
+		}
+#else
+		for (size_t k = 0; k < numAgents; ++k) {
+			agents[k]->computeNewVelocity(scratch);
+		}
+#endif
+	}
 
-				agentNeighbors_[i] = std::make_pair(distSq, agent);
+	void Agent::computeSeparation(const AgentGrid &grid)
+	{
+		const Vector2 &position = sim_->agentPositions_[id_];
+		const size_t cellX = grid.getCellX(position.x());
+		const size_t cellY = grid.getCellY(position.y());
+
+		Vector2 push;
+
+		/* The cells are at least as large as the range of any pair of agents. */
+		for (size_t y = (cellY > 0 ? cellY - 1 : 0); y <= std::min(cellY + 1, grid.getNumCellsY() - 1); ++y) {
+			for (size_t x = (cellX > 0 ? cellX - 1 : 0); x <= std::min(cellX + 1, grid.getNumCellsX() - 1); ++x) {
+				for (size_t i = grid.cellBegin(x, y); i < grid.cellEnd(x, y); ++i) {
+					const size_t agentNo = grid.getAgentNo(i);
+
+					if (agentNo == id_) {
+						continue;
+					}
+
+					const Vector2 relativePosition = position - sim_->agentPositions_[agentNo];
+					const Real distSq = absSq(relativePosition);
+					const Real range = 2.0f * (radius_ + sim_->agents_[agentNo]->radius_);
 
-				if (agentNeighbors_.size() == maxNeighbors_) {
-					rangeSq = agentNeighbors_.back().first;
+					if (distSq < sqr(range) && distSq > 0.0f) {
+						const Real dist = std::sqrt(distSq);
+						push += relativePosition * ((range - dist) / (range * dist));
+					}
 				}
 			}
 		}
+
+		separation_ = maxSpeed_ * push;
 	}
 
-	void Agent::insertObstacleNeighbor(const Obstacle *obstacle, float rangeSq)
+	void Agent::computeLowDetailCandidates()
 	{
-		const Obstacle *const nextObstacle = obstacle->nextObstacle_;
+		/* The agent moves at most maxSpeed_ per step until the candidates are collected again. */
+		const Real range = timeHorizonObst_ * maxSpeed_ + radius_ + maxSpeed_ * sim_->timeStep_ * static_cast<Real>(sim_->lowDetailInterval_);
 
-		const float distSq = distSqPointLineSegment(obstacle->point_, nextObstacle->point_, position_);
+		obstacleCandidates_.clear();
+		sim_->kdTree_->computeObstacleCandidates(this, sqr(range));
+	}
 
-		if (distSq < rangeSq) {
-			obstacleNeighbors_.push_back(std::make_pair(distSq, obstacle));
+	void Agent::computeLowDetailVelocity(LinearProgramScratch &scratch)
+	{
+		Vector2 &newVelocity = sim_->agentNewVelocities_[id_];
+		const Vector2 optVelocity = sim_->agentPrefVelocities_[id_] + separation_;
+
+		const Vector2 &position = sim_->agentPositions_[id_];
+
+		/* Low-detail agents have no agent neighbors, so only obstacle lines are created. */
+		obstacleNeighbors_.reset();
+		const Real rangeSq = sqr(timeHorizonObst_ * maxSpeed_ + radius_);
 
-			size_t i = obstacleNeighbors_.size() - 1;
+		for (size_t i = 0; i < obstacleCandidates_.size(); ++i) {
+			const Obstacle *const obstacle = obstacleCandidates_[i];
 
-			while (i != 0 && distSq < obstacleNeighbors_[i - 1].first) {
-				obstacleNeighbors_[i] = obstacleNeighbors_[i - 1];
-				--i;
+			if (leftOf(obstacle->point_, obstacle->nextObstacle_->point_, position) < 0.0f) {
+				insertObstacleNeighbor(obstacle, rangeSq);
 			}
+		}
+
+		if (obstacleNeighbors_.size() == 0) {
+			orcaLines_.clear();
+			numObstLines_ = 0;
+			newVelocity = (absSq(optVelocity) > sqr(maxSpeed_) ? normalize(optVelocity) * maxSpeed_ : optVelocity);
+			return;
+		}
+
+		computeORCALines();
+
+		scratch.orcaLines.assign(orcaLines_);
+
+		size_t lineFail = linearProgram2(scratch.orcaLines, maxSpeed_, optVelocity, false, newVelocity);
+
+		if (lineFail < scratch.orcaLines.size()) {
+			linearProgram3(scratch.orcaLines, numObstLines_, lineFail, maxSpeed_, newVelocity, scratch.projLines);
+		}
+	}
+
+	void Agent::insertAgentNeighbor(const Agent *agent, Real distSq, Real &rangeSq)
+	{
+		agentNeighbors_.insert(distSq, agent);
+
+		if (agentNeighbors_.full()) {
+			rangeSq = agentNeighbors_.back().first;
+		}
+	}
 
-			obstacleNeighbors_[i] = std::make_pair(distSq, obstacle);
+	void Agent::insertObstacleNeighbor(const Obstacle *obstacle, Real rangeSq)
+	{
+		const Obstacle *const nextObstacle = obstacle->nextObstacle_;
+
+		const Real distSq = distSqPointLineSegment(obstacle->point_, nextObstacle->point_, sim_->agentPositions_[id_]);
+
+		if (distSq < rangeSq) {
+			obstacleNeighbors_.insert(distSq, obstacle);
 		}
 	}
 
-	void Agent::update()
+	size_t findViolatedLine(const LineSet &lines, size_t beginLine, const Vector2 &result, Real distance)
 	{
-		velocity_ = newVelocity_;
-		position_ += velocity_ * sim_->timeStep_;
+		const Real *const directionX = lines.directionX();
+		const Real *const directionY = lines.directionY();
+		const Real *const pointX = lines.pointX();
+		const Real *const pointY = lines.pointY();
+
+		size_t i = beginLine;
+
+#ifdef RVO_SSE2
+		const __m128 resultX = _mm_set1_ps(result.x());
+		const __m128 resultY = _mm_set1_ps(result.y());
+		const __m128 distances = _mm_set1_ps(distance);
+
+		for (; i + 4 <= lines.size(); i += 4) {
+			const __m128 violations = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(directionX + i), _mm_sub_ps(_mm_loadu_ps(pointY + i), resultY)), _mm_mul_ps(_mm_loadu_ps(directionY + i), _mm_sub_ps(_mm_loadu_ps(pointX + i), resultX)));
+			const int mask = _mm_movemask_ps(_mm_cmpgt_ps(violations, distances));
+
+			if (mask != 0) {
+				/* Return the first of the violated lines in this group. */
+				for (size_t j = 0; j < 4; ++j) {
+					if ((mask & (1 << j)) != 0) {
+						return i + j;
+					}
+				}
+			}
+		}
+#endif
+
+		for (; i < lines.size(); ++i) {
+			if (directionX[i] * (pointY[i] - result.y()) - directionY[i] * (pointX[i] - result.x()) > distance) {
+				return i;
+			}
+		}
+
+		return lines.size();
 	}
 
-	bool linearProgram1(const std::vector<Line> &lines, size_t lineNo, float radius, const Vector2 &optVelocity, bool directionOpt, Vector2 &result)
+	bool linearProgram1(const LineSet &lines, size_t lineNo, Real radius, const Vector2 &optVelocity, bool directionOpt, Vector2 &result)
 	{
-		const float dotProduct = lines[lineNo].point * lines[lineNo].direction;
-		const float discriminant = sqr(dotProduct) + sqr(radius) - absSq(lines[lineNo].point);
+		const Real *const directionX = lines.directionX();
+		const Real *const directionY = lines.directionY();
+		const Real *const pointX = lines.pointX();
+		const Real *const pointY = lines.pointY();
+
+		const Vector2 lineDirection(directionX[lineNo], directionY[lineNo]);
+		const Vector2 linePoint(pointX[lineNo], pointY[lineNo]);
+
+		const Real dotProduct = linePoint * lineDirection;
+		const Real discriminant = sqr(dotProduct) + sqr(radius) - absSq(linePoint);
 
 		if (discriminant < 0.0f) {
 			/* Max speed circle fully invalidates line lineNo. */
 			return false;
 		}
 
-		const float sqrtDiscriminant = std::sqrt(discriminant);
-		float tLeft = -dotProduct - sqrtDiscriminant;
-		float tRight = -dotProduct + sqrtDiscriminant;
+		const Real sqrtDiscriminant = std::sqrt(discriminant);
+		Real tLeft = -dotProduct - sqrtDiscriminant;
+		Real tRight = -dotProduct + sqrtDiscriminant;
+
+		size_t i = 0;
+
+#ifdef RVO_SSE2
+		if (lineNo >= 4) {
+			/*
+			 * Bound line lineNo by four lines at a time. The bounds only ever
+			 * tighten, so testing them once after the loop gives the same
+			 * answer as testing them after every line.
+			 */
+			const __m128 lineDirectionX = _mm_set1_ps(lineDirection.x());
+			const __m128 lineDirectionY = _mm_set1_ps(lineDirection.y());
+			const __m128 linePointX = _mm_set1_ps(linePoint.x());
+			const __m128 linePointY = _mm_set1_ps(linePoint.y());
+			const __m128 epsilon = _mm_set1_ps(RVO_EPSILON);
+			const __m128 signBit = _mm_set1_ps(-0.0f);
+			const __m128 zero = _mm_setzero_ps();
+
+			__m128 infeasible = zero;
+			__m128 lefts = _mm_set1_ps(tLeft);
+			__m128 rights = _mm_set1_ps(tRight);
+
+			for (; i + 4 <= lineNo; i += 4) {
+				const __m128 otherDirectionX = _mm_loadu_ps(directionX + i);
+				const __m128 otherDirectionY = _mm_loadu_ps(directionY + i);
+
+				const __m128 denominators = _mm_sub_ps(_mm_mul_ps(lineDirectionX, otherDirectionY), _mm_mul_ps(lineDirectionY, otherDirectionX));
+				const __m128 numerators = _mm_sub_ps(_mm_mul_ps(otherDirectionX, _mm_sub_ps(linePointY, _mm_loadu_ps(pointY + i))), _mm_mul_ps(otherDirectionY, _mm_sub_ps(linePointX, _mm_loadu_ps(pointX + i))));
+
+				/* Lines lineNo and i are (almost) parallel. */
+				const __m128 parallel = _mm_cmple_ps(_mm_andnot_ps(signBit, denominators), epsilon);
+				infeasible = _mm_or_ps(infeasible, _mm_and_ps(parallel, _mm_cmplt_ps(numerators, zero)));
+
+				const __m128 t = _mm_div_ps(numerators, denominators);
+				const __m128 boundsRight = _mm_andnot_ps(parallel, _mm_cmpge_ps(denominators, zero));
+				const __m128 boundsLeft = _mm_andnot_ps(parallel, _mm_cmplt_ps(denominators, zero));
+
+				rights = _mm_or_ps(_mm_and_ps(boundsRight, _mm_min_ps(t, rights)), _mm_andnot_ps(boundsRight, rights));
+				lefts = _mm_or_ps(_mm_and_ps(boundsLeft, _mm_max_ps(t, lefts)), _mm_andnot_ps(boundsLeft, lefts));
+			}
+
+			Real leftValues[4];
+			Real rightValues[4];
+			_mm_storeu_ps(leftValues, lefts);
+			_mm_storeu_ps(rightValues, rights);
 
-		for (size_t i = 0; i < lineNo; ++i) {
-			const float denominator = det(lines[lineNo].direction, lines[i].direction);
-			const float numerator = det(lines[i].direction, lines[lineNo].point - lines[i].point);
+			for (size_t j = 0; j < 4; ++j) {
+				tLeft = std::max(tLeft, leftValues[j]);
+				tRight = std::min(tRight, rightValues[j]);
+			}
+
+			if (_mm_movemask_ps(infeasible) != 0 || tLeft > tRight) {
+				return false;
+			}
+		}
+#endif
+
+		for (; i < lineNo; ++i) {
+			const Real denominator = lineDirection.x() * directionY[i] - lineDirection.y() * directionX[i];
+			const Real numerator = directionX[i] * (linePoint.y() - pointY[i]) - directionY[i] * (linePoint.x() - pointX[i]);
 
 			if (std::fabs(denominator) <= RVO_EPSILON) {
 				/* Lines lineNo and i are (almost) parallel. */
@@ -461,7 +891,7 @@ namespace RVO {
 				}
 			}
 
-			const float t = numerator / denominator;
+			const Real t = numerator / denominator;
 
 			if (denominator >= 0.0f) {
 				/* Line i bounds line lineNo on the right. */
@@ -479,34 +909,34 @@ namespace RVO {
 
 		if (directionOpt) {
 			/* Optimize direction. */
-			if (optVelocity * lines[lineNo].direction > 0.0f) {
+			if (optVelocity * lineDirection > 0.0f) {
 				/* Take right extreme. */
-				result = lines[lineNo].point + tRight * lines[lineNo].direction;
+				result = linePoint + tRight * lineDirection;
 			}
 			else {
 				/* Take left extreme. */
-				result = lines[lineNo].point + tLeft * lines[lineNo].direction;
+				result = linePoint + tLeft * lineDirection;
 			}
 		}
 		else {
 			/* Optimize closest point. */
-			const float t = lines[lineNo].direction * (optVelocity - lines[lineNo].point);
+			const Real t = lineDirection * (optVelocity - linePoint);
 
 			if (t < tLeft) {
-				result = lines[lineNo].point + tLeft * lines[lineNo].direction;
+				result = linePoint + tLeft * lineDirection;
 			}
 			else if (t > tRight) {
-				result = lines[lineNo].point + tRight * lines[lineNo].direction;
+				result = linePoint + tRight * lineDirection;
 			}
 			else {
-				result = lines[lineNo].point + t * lines[lineNo].direction;
+				result = linePoint + t * lineDirection;
 			}
 		}
 
 		return true;
 	}
 
-	size_t linearProgram2(const std::vector<Line> &lines, float radius, const Vector2 &optVelocity, bool directionOpt, Vector2 &result)
+	size_t linearProgram2(const LineSet &lines, Real radius, const Vector2 &optVelocity, bool directionOpt, Vector2 &result)
 	{
 		if (directionOpt) {
 			/*
@@ -524,67 +954,67 @@ namespace RVO {
 			result = optVelocity;
 		}
 
-		for (size_t i = 0; i < lines.size(); ++i) {
-			if (det(lines[i].direction, lines[i].point - result) > 0.0f) {
-				/* Result does not satisfy constraint i. Compute new optimal result. */
-				const Vector2 tempResult = result;
+		for (size_t i = findViolatedLine(lines, 0, result, 0.0f); i < lines.size(); i = findViolatedLine(lines, i + 1, result, 0.0f)) {
+			/* Result does not satisfy constraint i. Compute new optimal result. */
+			const Vector2 tempResult = result;
 
-				if (!linearProgram1(lines, i, radius, optVelocity, directionOpt, result)) {
-					result = tempResult;
-					return i;
-				}
+			if (!linearProgram1(lines, i, radius, optVelocity, directionOpt, result)) {
+				result = tempResult;
+				return i;
 			}
 		}
 
 		return lines.size();
 	}
 
-	void linearProgram3(const std::vector<Line> &lines, size_t numObstLines, size_t beginLine, float radius, Vector2 &result)
+	void linearProgram3(const LineSet &lines, size_t numObstLines, size_t beginLine, Real radius, Vector2 &result, LineSet &projLines)
 	{
-		float distance = 0.0f;
-
-		for (size_t i = beginLine; i < lines.size(); ++i) {
-			if (det(lines[i].direction, lines[i].point - result) > distance) {
-				/* Result does not satisfy constraint of line i. */
-				std::vector<Line> projLines(lines.begin(), lines.begin() + static_cast<ptrdiff_t>(numObstLines));
-
-				for (size_t j = numObstLines; j < i; ++j) {
-					Line line;
-
-					float determinant = det(lines[i].direction, lines[j].direction);
-
-					if (std::fabs(determinant) <= RVO_EPSILON) {
-						/* Line i and line j are parallel. */
-						if (lines[i].direction * lines[j].direction > 0.0f) {
-							/* Line i and line j point in the same direction. */
-							continue;
-						}
-						else {
-							/* Line i and line j point in opposite direction. */
-							line.point = 0.5f * (lines[i].point + lines[j].point);
-						}
+		Real distance = 0.0f;
+
+		for (size_t i = findViolatedLine(lines, beginLine, result, distance); i < lines.size(); i = findViolatedLine(lines, i + 1, result, distance)) {
+			/* Result does not satisfy constraint of line i. */
+			const Line lineI = lines[i];
+
+			projLines.assign(lines, numObstLines);
+
+			for (size_t j = numObstLines; j < i; ++j) {
+				const Line lineJ = lines[j];
+
+				Line line;
+
+				Real determinant = det(lineI.direction, lineJ.direction);
+
+				if (std::fabs(determinant) <= RVO_EPSILON) {
+					/* Line i and line j are parallel. */
+					if (lineI.direction * lineJ.direction > 0.0f) {
+						/* Line i and line j point in the same direction. */
+						continue;
 					}
 					else {
-						line.point = lines[i].point + (det(lines[j].direction, lines[i].point - lines[j].point) / determinant) * lines[i].direction;
+						/* Line i and line j point in opposite direction. */
+						line.point = 0.5f * (lineI.point + lineJ.point);
 					}
-
-					line.direction = normalize(lines[j].direction - lines[i].direction);
-					projLines.push_back(line);
+				}
+				else {
+					line.point = lineI.point + (det(lineJ.direction, lineI.point - lineJ.point) / determinant) * lineI.direction;
 				}
 
-				const Vector2 tempResult = result;
+				line.direction = normalize(lineJ.direction - lineI.direction);
+				projLines.push_back(line);
+			}
 
-				if (linearProgram2(projLines, radius, Vector2(-lines[i].direction.y(), lines[i].direction.x()), true, result) < projLines.size()) {
-					/* This should in principle not happen.  The result is by definition
-					 * already in the feasible region of this linear program. If it fails,
-					 * it is due to small floating point error, and the current result is
-					 * kept.
-					 */
-					result = tempResult;
-				}
+			const Vector2 tempResult = result;
 
-				distance = det(lines[i].direction, lines[i].point - result);
+			if (linearProgram2(projLines, radius, Vector2(-lineI.direction.y(), lineI.direction.x()), true, result) < projLines.size()) {
+				/* This should in principle not happen.  The result is by definition
+				 * already in the feasible region of this linear program. If it fails,
+				 * it is due to small floating point error, and the current result is
+				 * kept.
+				 */
+				result = tempResult;
 			}
+
+			distance = det(lineI.direction, lineI.point - result);
 		}
 	}
 }
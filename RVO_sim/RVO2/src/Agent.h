@@ -63,11 +63,67 @@
  */
 
 #include "Definitions.h"
+#include "LineSet.h"
+#include "NeighborSet.h"
 #include "RVOSimulator.h"
 
 namespace RVO {
+	/**
+	 * \brief      Defines scratch storage for the linear programs of one
+	 *             thread, reused across agents and simulation steps.
+	 */
+	class RVO_ALIGN_CACHE_LINE LinearProgramScratch {
+	public:
+		/**
+		 * \brief      Allocates scratch storage starting on its own cache
+		 *             line, so that the scratch of different threads never
+		 *             shares one.
+		 * \param      size            The size of the storage in bytes.
+		 * \return     The aligned storage.
+		 */
+		static void *operator new(size_t size)
+		{
+			void *raw = ::operator new(size + RVO_CACHE_LINE_SIZE + sizeof(void *));
+			void **aligned = reinterpret_cast<void **>((reinterpret_cast<uintptr_t>(raw) + sizeof(void *) + RVO_CACHE_LINE_SIZE - 1) & ~static_cast<uintptr_t>(RVO_CACHE_LINE_SIZE - 1));
+			aligned[-1] = raw;
+			return aligned;
+		}
+
+		/**
+		 * \brief      Frees scratch storage allocated by operator new.
+		 * \param      ptr             The aligned storage.
+		 */
+		static void operator delete(void *ptr)
+		{
+			if (ptr != NULL) {
+				::operator delete(static_cast<void **>(ptr)[-1]);
+			}
+		}
+
+		/**
+		 * \brief      The ORCA lines of a group of agents solved together,
+		 *             interleaved so that each agent occupies one SIMD lane.
+		 */
+		std::vector<Real> groupLines;
+
+		/**
+		 * \brief      The ORCA lines of the agent being solved.
+		 */
+		LineSet orcaLines;
+
+		/**
+		 * \brief      The projected lines of the three-dimensional linear
+		 *             program.
+		 */
+		LineSet projLines;
+	};
+
 	/**
 	 * \brief      Defines an agent in the simulation.
+	 *
+	 * The position and velocities of the agent are kept in contiguous arrays
+	 * of the simulator, indexed by the number of the agent, so that the
+	 * phases of a simulation step stream through them.
 	 */
 	class Agent {
 	private:
@@ -83,17 +139,79 @@ namespace RVO {
 		void computeNeighbors();
 
 		/**
-		 * \brief      Computes the new velocity of this agent.
+		 * \brief      Computes for how many further steps this agent, which has
+		 *             no neighbors, certainly keeps having none. Agents and
+		 *             obstacles are searched within a margin of the neighbor
+		 *             distance beyond the ranges, which no agent can cover
+		 *             sooner than at the maximum speeds of both.
+		 */
+		void computeFreeFlightSteps();
+
+		/**
+		 * \brief      Computes the neighbors of this agent by filtering its
+		 *             cached neighbor candidates, collecting the candidates
+		 *             first if the simulator rebuilds its neighbor lists.
+		 */
+		void computeNeighborsFromCandidates();
+
+		/**
+		 * \brief      Collects the obstacles this low-detail agent may come
+		 *             close to before the next update of the low-detail agents.
 		 */
-		void computeNewVelocity();
+		void computeLowDetailCandidates();
+
+		/**
+		 * \brief      Computes the new velocity of this low-detail agent: its
+		 *             preferred velocity plus its separation, kept out of the
+		 *             nearby obstacles by their ORCA lines.
+		 * \param      scratch         The scratch storage of the calling thread.
+		 */
+		void computeLowDetailVelocity(LinearProgramScratch &scratch);
+
+		/**
+		 * \brief      Computes the new velocity of this agent from its ORCA
+		 *             lines.
+		 * \param      scratch         The scratch storage of the calling thread.
+		 */
+		void computeNewVelocity(LinearProgramScratch &scratch);
+
+		/**
+		 * \brief      Computes the new velocities of a group of up to four
+		 *             agents from their ORCA lines, solving the
+		 *             two-dimensional linear programs side by side.
+		 * \param      agents          The agents of the group.
+		 * \param      numAgents       The number of agents in the group. Must
+		 *                             be at most four.
+		 * \param      scratch         The scratch storage of the calling thread.
+		 */
+		static void computeNewVelocities(Agent *const *agents, size_t numAgents,
+										 LinearProgramScratch &scratch);
+
+		/**
+		 * \brief      Computes the ORCA lines of this agent from its neighbors.
+		 */
+		void computeORCALines();
+
+		/**
+		 * \brief      Computes the separation velocity of this low-detail agent,
+		 *             which pushes it away from the agents that are closer than
+		 *             twice the sum of their radii.
+		 * \param      grid            A grid of the positions of all agents,
+		 *                             with cells no smaller than four times the
+		 *                             largest radius.
+		 */
+		void computeSeparation(const AgentGrid &grid);
 
 		/**
 		 * \brief      Inserts an agent neighbor into the set of neighbors of
 		 *             this agent.
 		 * \param      agent           A pointer to the agent to be inserted.
+		 * \param      distSq          The squared distance between the agents.
+		 *                             Must be smaller than rangeSq.
 		 * \param      rangeSq         The squared range around this agent.
 		 */
-		void insertAgentNeighbor(const Agent *agent, float &rangeSq);
+		void insertAgentNeighbor(const Agent *agent, Real distSq,
+								 Real &rangeSq);
 
 		/**
 		 * \brief      Inserts a static obstacle neighbor into the set of neighbors
@@ -102,28 +220,26 @@ namespace RVO {
 		 *                             inserted.
 		 * \param      rangeSq         The squared range around this agent.
 		 */
-		void insertObstacleNeighbor(const Obstacle *obstacle, float rangeSq);
-
-		/**
-		 * \brief      Updates the two-dimensional position and two-dimensional
-		 *             velocity of this agent.
-		 */
-		void update();
+		void insertObstacleNeighbor(const Obstacle *obstacle, Real rangeSq);
 
-		std::vector<std::pair<float, const Agent *> > agentNeighbors_;
+		std::vector<const Agent *> agentCandidates_;
+		Real agentCandidateRangeSq_;
+		NeighborSet<const Agent *> agentNeighbors_;
+		bool dormant_;
+		size_t freeFlightSteps_;
+		bool lowDetail_;
 		size_t maxNeighbors_;
-		float maxSpeed_;
-		float neighborDist_;
-		Vector2 newVelocity_;
-		std::vector<std::pair<float, const Obstacle *> > obstacleNeighbors_;
+		Real maxSpeed_;
+		Real neighborDist_;
+		size_t numObstLines_;
+		std::vector<const Obstacle *> obstacleCandidates_;
+		NeighborSet<const Obstacle *> obstacleNeighbors_;
 		std::vector<Line> orcaLines_;
-		Vector2 position_;
-		Vector2 prefVelocity_;
-		float radius_;
+		Real radius_;
+		Vector2 separation_;
 		RVOSimulator *sim_;
-		float timeHorizon_;
-		float timeHorizonObst_;
-		Vector2 velocity_;
+		Real timeHorizon_;
+		Real timeHorizonObst_;
 
 		size_t id_;
 
@@ -131,6 +247,19 @@ namespace RVO {
 		friend class RVOSimulator;
 	};
 
+	/**
+	 * \relates    Agent
+	 * \brief      Finds the first line, starting at a specified line, whose
+	 *             constraint is violated by more than a specified distance.
+	 * \param      lines         Lines defining the linear constraints.
+	 * \param      beginLine     The first line to be tested.
+	 * \param      result        The velocity to be tested.
+	 * \param      distance      The allowed violation of the constraints.
+	 * \return     The number of the line, and the number of lines if none.
+	 */
+	size_t findViolatedLine(const LineSet &lines, size_t beginLine,
+							const Vector2 &result, Real distance);
+
 	/**
 	 * \relates    Agent
 	 * \brief      Solves a one-dimensional linear program on a specified line
@@ -144,8 +273,8 @@ namespace RVO {
 	 * \param      result        A reference to the result of the linear program.
 	 * \return     True if successful.
 	 */
-	bool linearProgram1(const std::vector<Line> &lines, size_t lineNo,
-						float radius, const Vector2 &optVelocity,
+	bool linearProgram1(const LineSet &lines, size_t lineNo,
+						Real radius, const Vector2 &optVelocity,
 						bool directionOpt, Vector2 &result);
 
 	/**
@@ -159,7 +288,7 @@ namespace RVO {
 	 * \param      result        A reference to the result of the linear program.
 	 * \return     The number of the line it fails on, and the number of lines if successful.
 	 */
-	size_t linearProgram2(const std::vector<Line> &lines, float radius,
+	size_t linearProgram2(const LineSet &lines, Real radius,
 						  const Vector2 &optVelocity, bool directionOpt,
 						  Vector2 &result);
 
@@ -172,9 +301,11 @@ namespace RVO {
 	 * \param      beginLine     The line on which the 2-d linear program failed.
 	 * \param      radius        The radius of the circular constraint.
 	 * \param      result        A reference to the result of the linear program.
+	 * \param      projLines     Scratch storage for the projected lines, whose
+	 *                           capacity is reused between calls.
 	 */
-	void linearProgram3(const std::vector<Line> &lines, size_t numObstLines, size_t beginLine,
-						float radius, Vector2 &result);
+	void linearProgram3(const LineSet &lines, size_t numObstLines, size_t beginLine,
+						Real radius, Vector2 &result, LineSet &projLines);
 }
 
 #endif /* RVO_AGENT_H_ */
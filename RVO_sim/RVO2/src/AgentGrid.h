@@ -0,0 +1,252 @@
+/*
+ * AgentGrid.h
+ * RVO2 Library
+ *
+ * Copyright (c) 2008-2010 University of North Carolina at Chapel Hill.
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation for educational, research, and non-profit purposes, without
+ * fee, and without a written agreement is hereby granted, provided that the
+ * above copyright notice, this paragraph, and the following four paragraphs
+ * appear in all copies.
+ *
+ * Permission to incorporate this software into commercial products may be
+ * obtained by contacting the authors <geom@cs.unc.edu> or the Office of
+ * Technology Development at the University of North Carolina at Chapel Hill
+ * <otd@unc.edu>.
+ *
+ * This software program and documentation are copyrighted by the University of
+ * North Carolina at Chapel Hill. The software program and documentation are
+ * supplied "as is," without any accompanying services from the University of
+ * North Carolina at Chapel Hill or the authors. The University of North
+ * Carolina at Chapel Hill and the authors do not warrant that the operation of
+ * the program will be uninterrupted or error-free. The end-user understands
+ * that the program was developed for research purposes and is advised not to
+ * rely exclusively on the program for any reason.
+ *
+ * IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE
+ * AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR
+ * CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS
+ * SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE UNIVERSITY OF NORTH CAROLINA AT
+ * CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ * DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ * STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS ON
+ * AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE
+ * AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ *
+ * Please send all bug reports to <geom@cs.unc.edu>.
+ *
+ * The authors may be contacted via:
+ *
+ * Jur van den Berg, Stephen J. Guy, Jamie Snape, Ming C. Lin, Dinesh Manocha
+ * Dept. of Computer Science
+ * 201 S. Columbia St.
+ * Frederick P. Brooks, Jr. Computer Science Bldg.
+ * Chapel Hill, N.C. 27599-3175
+ * United States of America
+ *
+ * <http://gamma.cs.unc.edu/RVO2/>
+ */
+
+#ifndef RVO_AGENT_GRID_H_
+#define RVO_AGENT_GRID_H_
+
+/**
+ * \file       AgentGrid.h
+ * \brief      Contains the AgentGrid class.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "Vector2.h"
+
+namespace RVO {
+	/**
+	 * \brief      Defines a uniform grid of square cells over agent positions,
+	 *             for coarse queries of the agents near a point.
+	 *
+	 * The agents are sorted by cell, so that the agents of a cell are stored
+	 * contiguously. The grid covers the bounding box of the positions it was
+	 * built from.
+	 */
+	class AgentGrid {
+	public:
+		/**
+		 * \brief      Constructs an empty grid.
+		 */
+		AgentGrid() : cellSize_(1.0f), numCellsX_(0), numCellsY_(0) { }
+
+		/**
+		 * \brief      Sorts the specified positions into a grid.
+		 * \param      positions       The positions, indexed by agent number.
+		 * \param      cellSize        The minimum side length of the cells. Must
+		 *                             be positive. The cells are enlarged so that
+		 *                             there are not many more cells than
+		 *                             positions.
+		 */
+		void build(const std::vector<Vector2> &positions, Real cellSize)
+		{
+			numCellsX_ = 0;
+			numCellsY_ = 0;
+			agentNos_.resize(positions.size());
+
+			if (positions.empty()) {
+				cellStarts_.assign(1, 0);
+				return;
+			}
+
+			Vector2 maxPoint = positions[0];
+			minPoint_ = positions[0];
+
+			for (size_t i = 1; i < positions.size(); ++i) {
+				minPoint_ = Vector2(std::min(minPoint_.x(), positions[i].x()), std::min(minPoint_.y(), positions[i].y()));
+				maxPoint = Vector2(std::max(maxPoint.x(), positions[i].x()), std::max(maxPoint.y(), positions[i].y()));
+			}
+
+			const Real width = maxPoint.x() - minPoint_.x();
+			const Real height = maxPoint.y() - minPoint_.y();
+
+			/* At most about four cells per position. */
+			cellSize_ = std::max(cellSize, std::sqrt(width * height / (4.0f * positions.size())));
+
+			if (cellSize_ <= 0.0f) {
+				cellSize_ = 1.0f;
+			}
+			numCellsX_ = static_cast<size_t>(width / cellSize_) + 1;
+			numCellsY_ = static_cast<size_t>(height / cellSize_) + 1;
+
+			cellStarts_.assign(numCellsX_ * numCellsY_ + 1, 0);
+			agentCells_.resize(positions.size());
+
+			for (size_t i = 0; i < positions.size(); ++i) {
+				agentCells_[i] = getCellY(positions[i].y()) * numCellsX_ + getCellX(positions[i].x());
+				++cellStarts_[agentCells_[i] + 1];
+			}
+
+			for (size_t i = 1; i < cellStarts_.size(); ++i) {
+				cellStarts_[i] += cellStarts_[i - 1];
+			}
+
+			/* Counting sort, stable in agent number. */
+			cellEnds_.assign(cellStarts_.begin(), cellStarts_.end() - 1);
+
+			for (size_t i = 0; i < positions.size(); ++i) {
+				agentNos_[cellEnds_[agentCells_[i]]++] = i;
+			}
+		}
+
+		/**
+		 * \brief      Returns the position in the cell order at which the
+		 *             agents of a specified cell begin.
+		 * \param      cellX           The column of the cell.
+		 * \param      cellY           The row of the cell.
+		 * \return     The position of the first agent of the cell.
+		 */
+		size_t cellBegin(size_t cellX, size_t cellY) const
+		{
+			return cellStarts_[cellY * numCellsX_ + cellX];
+		}
+
+		/**
+		 * \brief      Returns the position in the cell order past the agents of
+		 *             a specified cell.
+		 * \param      cellX           The column of the cell.
+		 * \param      cellY           The row of the cell.
+		 * \return     The position past the last agent of the cell.
+		 */
+		size_t cellEnd(size_t cellX, size_t cellY) const
+		{
+			return cellStarts_[cellY * numCellsX_ + cellX + 1];
+		}
+
+		/**
+		 * \brief      Returns the agent number at a specified position in the
+		 *             cell order.
+		 * \param      i               The position in the cell order.
+		 * \return     The number of the agent.
+		 */
+		size_t getAgentNo(size_t i) const
+		{
+			return agentNos_[i];
+		}
+
+		/**
+		 * \brief      Returns the column of the cell containing a specified
+		 *             x-coordinate, clamped to the grid.
+		 * \param      x               The x-coordinate.
+		 * \return     The column of the cell.
+		 */
+		size_t getCellX(Real x) const
+		{
+			return getCell(x - minPoint_.x(), numCellsX_);
+		}
+
+		/**
+		 * \brief      Returns the row of the cell containing a specified
+		 *             y-coordinate, clamped to the grid.
+		 * \param      y               The y-coordinate.
+		 * \return     The row of the cell.
+		 */
+		size_t getCellY(Real y) const
+		{
+			return getCell(y - minPoint_.y(), numCellsY_);
+		}
+
+		/**
+		 * \brief      Returns the side length of the cells.
+		 * \return     The side length of the cells.
+		 */
+		Real getCellSize() const
+		{
+			return cellSize_;
+		}
+
+		/**
+		 * \brief      Returns the number of columns of the grid.
+		 * \return     The number of columns (zero if the grid is empty).
+		 */
+		size_t getNumCellsX() const
+		{
+			return numCellsX_;
+		}
+
+		/**
+		 * \brief      Returns the number of rows of the grid.
+		 * \return     The number of rows (zero if the grid is empty).
+		 */
+		size_t getNumCellsY() const
+		{
+			return numCellsY_;
+		}
+
+	private:
+		size_t getCell(Real offset, size_t numCells) const
+		{
+			if (offset <= 0.0f) {
+				return 0;
+			}
+
+			return std::min(static_cast<size_t>(offset / cellSize_), numCells - 1);
+		}
+
+		std::vector<size_t> agentCells_;
+		std::vector<size_t> agentNos_;
+		std::vector<size_t> cellEnds_;
+		Real cellSize_;
+		std::vector<size_t> cellStarts_;
+		Vector2 minPoint_;
+		size_t numCellsX_;
+		size_t numCellsY_;
+	};
+}
+
+#endif /* RVO_AGENT_GRID_H_ */
@@ -0,0 +1,140 @@
+/*
+ * Arena.h
+ * RVO2 Library
+ *
+ * Copyright (c) 2008-2010 University of North Carolina at Chapel Hill.
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation for educational, research, and non-profit purposes, without
+ * fee, and without a written agreement is hereby granted, provided that the
+ * above copyright notice, this paragraph, and the following four paragraphs
+ * appear in all copies.
+ *
+ * Permission to incorporate this software into commercial products may be
+ * obtained by contacting the authors <geom@cs.unc.edu> or the Office of
+ * Technology Development at the University of North Carolina at Chapel Hill
+ * <otd@unc.edu>.
+ *
+ * This software program and documentation are copyrighted by the University of
+ * North Carolina at Chapel Hill. The software program and documentation are
+ * supplied "as is," without any accompanying services from the University of
+ * North Carolina at Chapel Hill or the authors. The University of North
+ * Carolina at Chapel Hill and the authors do not warrant that the operation of
+ * the program will be uninterrupted or error-free. The end-user understands
+ * that the program was developed for research purposes and is advised not to
+ * rely exclusively on the program for any reason.
+ *
+ * IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE
+ * AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR
+ * CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS
+ * SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE UNIVERSITY OF NORTH CAROLINA AT
+ * CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ * DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ * STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS ON
+ * AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE
+ * AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ *
+ * Please send all bug reports to <geom@cs.unc.edu>.
+ *
+ * The authors may be contacted via:
+ *
+ * Jur van den Berg, Stephen J. Guy, Jamie Snape, Ming C. Lin, Dinesh Manocha
+ * Dept. of Computer Science
+ * 201 S. Columbia St.
+ * Frederick P. Brooks, Jr. Computer Science Bldg.
+ * Chapel Hill, N.C. 27599-3175
+ * United States of America
+ *
+ * <http://gamma.cs.unc.edu/RVO2/>
+ */
+
+#ifndef RVO_ARENA_H_
+#define RVO_ARENA_H_
+
+/**
+ * \file       Arena.h
+ * \brief      Contains the Arena class.
+ */
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace RVO {
+	/**
+	 * \brief      Defines an arena that owns objects allocated in contiguous
+	 *             blocks.
+	 *
+	 * Allocation bumps an index into the current block. Blocks are kept when
+	 * the arena is cleared and reused by later allocations, and are released
+	 * all at once when the arena is destroyed.
+	 */
+	template <class T>
+	class Arena {
+	public:
+		/**
+		 * \brief      Constructs an empty arena.
+		 * \param      blockSize       The number of objects per block
+		 *                             (optional). Must be positive.
+		 */
+		explicit Arena(size_t blockSize = 256) : blockSize_(blockSize), size_(0) { }
+
+		/**
+		 * \brief      Destroys this arena and all objects in it.
+		 */
+		~Arena()
+		{
+			clear();
+
+			for (size_t i = 0; i < blocks_.size(); ++i) {
+				::operator delete(blocks_[i]);
+			}
+		}
+
+		/**
+		 * \brief      Returns uninitialized storage for one object, which the
+		 *             caller must construct with placement new. The object is
+		 *             destroyed by the arena.
+		 * \return     A pointer to the storage.
+		 */
+		void *allocate()
+		{
+			const size_t block = size_ / blockSize_;
+
+			if (block == blocks_.size()) {
+				blocks_.push_back(static_cast<T *>(::operator new(blockSize_ * sizeof(T))));
+			}
+
+			return blocks_[block] + size_++ % blockSize_;
+		}
+
+		/**
+		 * \brief      Destroys all objects in this arena, keeping its blocks
+		 *             for reuse.
+		 */
+		void clear()
+		{
+			for (size_t i = 0; i < size_; ++i) {
+				(blocks_[i / blockSize_] + i % blockSize_)->~T();
+			}
+
+			size_ = 0;
+		}
+
+	private:
+		Arena(const Arena &);
+		Arena &operator=(const Arena &);
+
+		std::vector<T *> blocks_;
+		size_t blockSize_;
+		size_t size_;
+	};
+}
+
+#endif /* RVO_ARENA_H_ */
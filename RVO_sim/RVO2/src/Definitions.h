@@ -67,6 +67,8 @@
 #include <limits>
 #include <vector>
 
+#include <stdint.h>
+
 #include "Vector2.h"
 
 /**
@@ -74,6 +76,30 @@
  */
 const float RVO_EPSILON = 0.00001f;
 
+#if defined(__SSE2__) && !defined(RVO_DOUBLE_PRECISION) && !defined(RVO_SCALAR)
+/**
+ * \brief       Defined if the linear programs use SSE2 kernels, which operate
+ *              on single precision only. Defining RVO_SCALAR builds the scalar
+ *              linear programs instead, e.g. to check the kernels against them.
+ */
+#define RVO_SSE2
+#endif
+
+/**
+ * \brief       The size of a cache line in bytes, assumed for keeping the data
+ *              of different threads apart.
+ */
+#define RVO_CACHE_LINE_SIZE 64
+
+/**
+ * \brief       Aligns a class to a cache line.
+ */
+#if defined(_MSC_VER)
+#define RVO_ALIGN_CACHE_LINE __declspec(align(64))
+#else
+#define RVO_ALIGN_CACHE_LINE __attribute__((aligned(64)))
+#endif
+
 namespace RVO {
 	class Agent;
 	class Obstacle;
@@ -88,10 +114,10 @@ namespace RVO {
 	 *                             be calculated.
 	 * \return     The squared distance from the line segment to the point.
 	 */
-	inline float distSqPointLineSegment(const Vector2 &a, const Vector2 &b,
+	inline Real distSqPointLineSegment(const Vector2 &a, const Vector2 &b,
 										const Vector2 &c)
 	{
-		const float r = ((c - a) * (b - a)) / absSq(b - a);
+		const Real r = ((c - a) * (b - a)) / absSq(b - a);
 
 		if (r < 0.0f) {
 			return absSq(c - a);
@@ -113,17 +139,17 @@ namespace RVO {
 	 *                             be calculated.
 	 * \return     Positive when the point c lies to the left of the line ab.
 	 */
-	inline float leftOf(const Vector2 &a, const Vector2 &b, const Vector2 &c)
+	inline Real leftOf(const Vector2 &a, const Vector2 &b, const Vector2 &c)
 	{
 		return det(a - c, b - a);
 	}
 
 	/**
-	 * \brief      Computes the square of a float.
-	 * \param      a               The float to be squared.
-	 * \return     The square of the float.
+	 * \brief      Computes the square of a scalar.
+	 * \param      a               The scalar to be squared.
+	 * \return     The square of the scalar.
 	 */
-	inline float sqr(float a)
+	inline Real sqr(Real a)
 	{
 		return a * a;
 	}
@@ -56,66 +56,105 @@
 
 #include "KdTree.h"
 
+#include <new>
+
 #include "Agent.h"
 #include "RVOSimulator.h"
 #include "Obstacle.h"
 
 namespace RVO {
-	KdTree::KdTree(RVOSimulator *sim) : obstacleTree_(NULL), sim_(sim) { }
+	KdTree::KdTree(RVOSimulator *sim) : numAgents_(0), obstacleTree_(NULL), sim_(sim) { }
 
-	KdTree::~KdTree()
-	{
-		deleteObstacleTree(obstacleTree_);
-	}
+	KdTree::~KdTree() { }
 
 	void KdTree::buildAgentTree()
 	{
-		if (agents_.size() < sim_->agents_.size()) {
-			for (size_t i = agents_.size(); i < sim_->agents_.size(); ++i) {
-				agents_.push_back(sim_->agents_[i]);
+		if (sim_->dormantAgentsChanged_ || numAgents_ < sim_->agents_.size()) {
+			/*
+			 * Both trees keep the order of their previous build, so that the
+			 * partitioning starts from nearly sorted agents.
+			 */
+			std::vector<Agent *> activeAgents;
+			std::vector<Agent *> dormantAgents;
+			activeAgents.reserve(sim_->agents_.size());
+
+			for (size_t i = 0; i < agentTree_.agents.size(); ++i) {
+				(agentTree_.agents[i]->dormant_ ? dormantAgents : activeAgents).push_back(agentTree_.agents[i]);
+			}
+
+			for (size_t i = 0; i < dormantAgentTree_.agents.size(); ++i) {
+				(dormantAgentTree_.agents[i]->dormant_ ? dormantAgents : activeAgents).push_back(dormantAgentTree_.agents[i]);
+			}
+
+			for (size_t i = numAgents_; i < sim_->agents_.size(); ++i) {
+				(sim_->agents_[i]->dormant_ ? dormantAgents : activeAgents).push_back(sim_->agents_[i]);
 			}
 
-			agentTree_.resize(2 * agents_.size() - 1);
+			numAgents_ = sim_->agents_.size();
+			agentTree_.agents.swap(activeAgents);
+
+			/* Dormant agents do not move, so their tree is built only on changes. */
+			if (sim_->dormantAgentsChanged_) {
+				dormantAgentTree_.agents.swap(dormantAgents);
+				buildAgentTree(dormantAgentTree_);
+			}
 		}
 
-		if (!agents_.empty()) {
-			buildAgentTreeRecursive(0, agents_.size(), 0);
+		buildAgentTree(agentTree_);
+	}
+
+	void KdTree::buildAgentTree(AgentTree &tree)
+	{
+		tree.nodes.resize(tree.agents.empty() ? 0 : 2 * tree.agents.size() - 1);
+		tree.positions.resize(tree.agents.size());
+
+		if (!tree.agents.empty()) {
+			/*
+			 * Gather the positions in tree order, so that building and querying
+			 * the tree stream through them.
+			 */
+			for (size_t i = 0; i < tree.agents.size(); ++i) {
+				tree.positions[i] = sim_->agentPositions_[tree.agents[i]->id_];
+			}
+
+			buildAgentTreeRecursive(tree, 0, tree.agents.size(), 0);
 		}
 	}
 
-	void KdTree::buildAgentTreeRecursive(size_t begin, size_t end, size_t node)
+	void KdTree::buildAgentTreeRecursive(AgentTree &tree, size_t begin, size_t end, size_t node)
 	{
-		agentTree_[node].begin = begin;
-		agentTree_[node].end = end;
-		agentTree_[node].minX = agentTree_[node].maxX = agents_[begin]->position_.x();
-		agentTree_[node].minY = agentTree_[node].maxY = agents_[begin]->position_.y();
+		tree.nodes[node].begin = begin;
+		tree.nodes[node].end = end;
+		tree.nodes[node].minX = tree.nodes[node].maxX = tree.positions[begin].x();
+		tree.nodes[node].minY = tree.nodes[node].maxY = tree.positions[begin].y();
 
 		for (size_t i = begin + 1; i < end; ++i) {
-			agentTree_[node].maxX = std::max(agentTree_[node].maxX, agents_[i]->position_.x());
-			agentTree_[node].minX = std::min(agentTree_[node].minX, agents_[i]->position_.x());
-			agentTree_[node].maxY = std::max(agentTree_[node].maxY, agents_[i]->position_.y());
-			agentTree_[node].minY = std::min(agentTree_[node].minY, agents_[i]->position_.y());
+			tree.nodes[node].maxX = std::max(tree.nodes[node].maxX, tree.positions[i].x());
+			tree.nodes[node].minX = std::min(tree.nodes[node].minX, tree.positions[i].x());
+			tree.nodes[node].maxY = std::max(tree.nodes[node].maxY, tree.positions[i].y());
+			tree.nodes[node].minY = std::min(tree.nodes[node].minY, tree.positions[i].y());
 		}
 
 		if (end - begin > MAX_LEAF_SIZE) {
 			/* No leaf node. */
-			const bool isVertical = (agentTree_[node].maxX - agentTree_[node].minX > agentTree_[node].maxY - agentTree_[node].minY);
-			const float splitValue = (isVertical ? 0.5f * (agentTree_[node].maxX + agentTree_[node].minX) : 0.5f * (agentTree_[node].maxY + agentTree_[node].minY));
+			const bool isVertical = (tree.nodes[node].maxX - tree.nodes[node].minX > tree.nodes[node].maxY - tree.nodes[node].minY);
+			const Real splitValue = (isVertical ? 0.5f * (tree.nodes[node].maxX + tree.nodes[node].minX) : 0.5f * (tree.nodes[node].maxY + tree.nodes[node].minY));
 
 			size_t left = begin;
 			size_t right = end;
 
 			while (left < right) {
-				while (left < right && (isVertical ? agents_[left]->position_.x() : agents_[left]->position_.y()) < splitValue) {
+				while (left < right && (isVertical ? tree.positions[left].x() : tree.positions[left].y()) < splitValue) {
 					++left;
 				}
 
-				while (right > left && (isVertical ? agents_[right - 1]->position_.x() : agents_[right - 1]->position_.y()) >= splitValue) {
+				while (right > left && (isVertical ? tree.positions[right - 1].x() : tree.positions[right - 1].y()) >= splitValue) {
 					--right;
 				}
 
 				if (left < right) {
-					std::swap(agents_[left], agents_[right - 1]);
+					std::swap(tree.agents[left], tree.agents[right - 1]);
+					std::swap(tree.positions[left], tree.positions[right - 1]);
 					++left;
 					--right;
 				}
@@ -126,17 +165,17 @@ namespace RVO {
 				++right;
 			}
 
-			agentTree_[node].left = node + 1;
-			agentTree_[node].right = node + 2 * (left - begin);
+			tree.nodes[node].left = node + 1;
+			tree.nodes[node].right = node + 2 * (left - begin);
 
-			buildAgentTreeRecursive(begin, left, agentTree_[node].left);
-			buildAgentTreeRecursive(left, end, agentTree_[node].right);
+			buildAgentTreeRecursive(tree, begin, left, tree.nodes[node].left);
+			buildAgentTreeRecursive(tree, left, end, tree.nodes[node].right);
 		}
 	}
 
 	void KdTree::buildObstacleTree()
 	{
-		deleteObstacleTree(obstacleTree_);
+		obstacleTreeNodes_.clear();
 
 		std::vector<Obstacle *> obstacles(sim_->obstacles_.size());
 
@@ -154,7 +193,7 @@ namespace RVO {
 			return NULL;
 		}
 		else {
-			ObstacleTreeNode *const node = new ObstacleTreeNode;
+			ObstacleTreeNode *const node = new (obstacleTreeNodes_.allocate()) ObstacleTreeNode;
 
 			size_t optimalSplit = 0;
 			size_t minLeft = obstacles.size();
@@ -176,8 +215,8 @@ namespace RVO {
 					const Obstacle *const obstacleJ1 = obstacles[j];
 					const Obstacle *const obstacleJ2 = obstacleJ1->nextObstacle_;
 
-					const float j1LeftOfI = leftOf(obstacleI1->point_, obstacleI2->point_, obstacleJ1->point_);
-					const float j2LeftOfI = leftOf(obstacleI1->point_, obstacleI2->point_, obstacleJ2->point_);
+					const Real j1LeftOfI = leftOf(obstacleI1->point_, obstacleI2->point_, obstacleJ1->point_);
+					const Real j2LeftOfI = leftOf(obstacleI1->point_, obstacleI2->point_, obstacleJ2->point_);
 
 					if (j1LeftOfI >= -RVO_EPSILON && j2LeftOfI >= -RVO_EPSILON) {
 						++leftSize;
@@ -221,8 +260,8 @@ namespace RVO {
 				Obstacle *const obstacleJ1 = obstacles[j];
 				Obstacle *const obstacleJ2 = obstacleJ1->nextObstacle_;
 
-				const float j1LeftOfI = leftOf(obstacleI1->point_, obstacleI2->point_, obstacleJ1->point_);
-				const float j2LeftOfI = leftOf(obstacleI1->point_, obstacleI2->point_, obstacleJ2->point_);
+				const Real j1LeftOfI = leftOf(obstacleI1->point_, obstacleI2->point_, obstacleJ1->point_);
+				const Real j2LeftOfI = leftOf(obstacleI1->point_, obstacleI2->point_, obstacleJ2->point_);
 
 				if (j1LeftOfI >= -RVO_EPSILON && j2LeftOfI >= -RVO_EPSILON) {
 					leftObstacles[leftCounter++] = obstacles[j];
@@ -232,11 +271,11 @@ namespace RVO {
 				}
 				else {
 					/* Split obstacle j. */
-					const float t = det(obstacleI2->point_ - obstacleI1->point_, obstacleJ1->point_ - obstacleI1->point_) / det(obstacleI2->point_ - obstacleI1->point_, obstacleJ1->point_ - obstacleJ2->point_);
+					const Real t = det(obstacleI2->point_ - obstacleI1->point_, obstacleJ1->point_ - obstacleI1->point_) / det(obstacleI2->point_ - obstacleI1->point_, obstacleJ1->point_ - obstacleJ2->point_);
 
 					const Vector2 splitpoint = obstacleJ1->point_ + t * (obstacleJ2->point_ - obstacleJ1->point_);
 
-					Obstacle *const newObstacle = new Obstacle();
+					Obstacle *const newObstacle = new (sim_->obstacleArena_->allocate()) Obstacle();
 					newObstacle->point_ = splitpoint;
 					newObstacle->prevObstacle_ = obstacleJ1;
 					newObstacle->nextObstacle_ = obstacleJ2;
@@ -268,52 +307,97 @@ namespace RVO {
 		}
 	}
 
-	void KdTree::computeAgentNeighbors(Agent *agent, float &rangeSq) const
+	void KdTree::computeAgentCandidates(Agent *agent, Real rangeSq) const
+	{
+		if (!agentTree_.agents.empty()) {
+			queryAgentCandidatesRecursive(agentTree_, agent, rangeSq, 0);
+		}
+
+		if (!dormantAgentTree_.agents.empty()) {
+			queryAgentCandidatesRecursive(dormantAgentTree_, agent, rangeSq, 0);
+		}
+	}
+
+	void KdTree::computeAgentNeighbors(Agent *agent, Real &rangeSq) const
 	{
-		queryAgentTreeRecursive(agent, rangeSq, 0);
+		if (!agentTree_.agents.empty()) {
+			queryAgentTreeRecursive(agentTree_, agent, rangeSq, 0);
+		}
+
+		if (!dormantAgentTree_.agents.empty()) {
+			queryAgentTreeRecursive(dormantAgentTree_, agent, rangeSq, 0);
+		}
 	}
 
-	void KdTree::computeObstacleNeighbors(Agent *agent, float rangeSq) const
+	void KdTree::computeObstacleNeighbors(Agent *agent, Real rangeSq) const
 	{
 		queryObstacleTreeRecursive(agent, rangeSq, obstacleTree_);
 	}
 
-	void KdTree::deleteObstacleTree(ObstacleTreeNode *node)
+	void KdTree::computeObstacleCandidates(Agent *agent, Real rangeSq) const
 	{
-		if (node != NULL) {
-			deleteObstacleTree(node->left);
-			deleteObstacleTree(node->right);
-			delete node;
+		queryObstacleCandidatesRecursive(agent, rangeSq, obstacleTree_);
+	}
+
+	void KdTree::queryAgentCandidatesRecursive(const AgentTree &tree, Agent *agent, Real rangeSq, size_t node) const
+	{
+		const Vector2 &position = sim_->agentPositions_[agent->id_];
+
+		if (tree.nodes[node].end - tree.nodes[node].begin <= MAX_LEAF_SIZE) {
+			for (size_t i = tree.nodes[node].begin; i < tree.nodes[node].end; ++i) {
+				if (absSq(position - tree.positions[i]) < rangeSq && tree.agents[i] != agent) {
+					agent->agentCandidates_.push_back(tree.agents[i]);
+				}
+			}
+		}
+		else {
+			const Real distSqLeft = sqr(std::max(Real(0), tree.nodes[tree.nodes[node].left].minX - position.x())) + sqr(std::max(Real(0), position.x() - tree.nodes[tree.nodes[node].left].maxX)) + sqr(std::max(Real(0), tree.nodes[tree.nodes[node].left].minY - position.y())) + sqr(std::max(Real(0), position.y() - tree.nodes[tree.nodes[node].left].maxY));
+
+			const Real distSqRight = sqr(std::max(Real(0), tree.nodes[tree.nodes[node].right].minX - position.x())) + sqr(std::max(Real(0), position.x() - tree.nodes[tree.nodes[node].right].maxX)) + sqr(std::max(Real(0), tree.nodes[tree.nodes[node].right].minY - position.y())) + sqr(std::max(Real(0), position.y() - tree.nodes[tree.nodes[node].right].maxY));
+
+			if (distSqLeft < rangeSq) {
+				queryAgentCandidatesRecursive(tree, agent, rangeSq, tree.nodes[node].left);
+			}
+
+			if (distSqRight < rangeSq) {
+				queryAgentCandidatesRecursive(tree, agent, rangeSq, tree.nodes[node].right);
+			}
 		}
 	}
 
-	void KdTree::queryAgentTreeRecursive(Agent *agent, float &rangeSq, size_t node) const
+	void KdTree::queryAgentTreeRecursive(const AgentTree &tree, Agent *agent, Real &rangeSq, size_t node) const
 	{
-		if (agentTree_[node].end - agentTree_[node].begin <= MAX_LEAF_SIZE) {
-			for (size_t i = agentTree_[node].begin; i < agentTree_[node].end; ++i) {
-				agent->insertAgentNeighbor(agents_[i], rangeSq);
+		const Vector2 &position = sim_->agentPositions_[agent->id_];
+
+		if (tree.nodes[node].end - tree.nodes[node].begin <= MAX_LEAF_SIZE) {
+			for (size_t i = tree.nodes[node].begin; i < tree.nodes[node].end; ++i) {
+				const Real distSq = absSq(position - tree.positions[i]);
+
+				if (distSq < rangeSq && tree.agents[i] != agent) {
+					agent->insertAgentNeighbor(tree.agents[i], distSq, rangeSq);
+				}
 			}
 		}
 		else {
-			const float distSqLeft = sqr(std::max(0.0f, agentTree_[agentTree_[node].left].minX - agent->position_.x())) + sqr(std::max(0.0f, agent->position_.x() - agentTree_[agentTree_[node].left].maxX)) + sqr(std::max(0.0f, agentTree_[agentTree_[node].left].minY - agent->position_.y())) + sqr(std::max(0.0f, agent->position_.y() - agentTree_[agentTree_[node].left].maxY));
+			const Real distSqLeft = sqr(std::max(Real(0), tree.nodes[tree.nodes[node].left].minX - position.x())) + sqr(std::max(Real(0), position.x() - tree.nodes[tree.nodes[node].left].maxX)) + sqr(std::max(Real(0), tree.nodes[tree.nodes[node].left].minY - position.y())) + sqr(std::max(Real(0), position.y() - tree.nodes[tree.nodes[node].left].maxY));
 
-			const float distSqRight = sqr(std::max(0.0f, agentTree_[agentTree_[node].right].minX - agent->position_.x())) + sqr(std::max(0.0f, agent->position_.x() - agentTree_[agentTree_[node].right].maxX)) + sqr(std::max(0.0f, agentTree_[agentTree_[node].right].minY - agent->position_.y())) + sqr(std::max(0.0f, agent->position_.y() - agentTree_[agentTree_[node].right].maxY));
+			const Real distSqRight = sqr(std::max(Real(0), tree.nodes[tree.nodes[node].right].minX - position.x())) + sqr(std::max(Real(0), position.x() - tree.nodes[tree.nodes[node].right].maxX)) + sqr(std::max(Real(0), tree.nodes[tree.nodes[node].right].minY - position.y())) + sqr(std::max(Real(0), position.y() - tree.nodes[tree.nodes[node].right].maxY));
 
 			if (distSqLeft < distSqRight) {
 				if (distSqLeft < rangeSq) {
-					queryAgentTreeRecursive(agent, rangeSq, agentTree_[node].left);
+					queryAgentTreeRecursive(tree, agent, rangeSq, tree.nodes[node].left);
 
 					if (distSqRight < rangeSq) {
-						queryAgentTreeRecursive(agent, rangeSq, agentTree_[node].right);
+						queryAgentTreeRecursive(tree, agent, rangeSq, tree.nodes[node].right);
 					}
 				}
 			}
 			else {
 				if (distSqRight < rangeSq) {
-					queryAgentTreeRecursive(agent, rangeSq, agentTree_[node].right);
+					queryAgentTreeRecursive(tree, agent, rangeSq, tree.nodes[node].right);
 
 					if (distSqLeft < rangeSq) {
-						queryAgentTreeRecursive(agent, rangeSq, agentTree_[node].left);
+						queryAgentTreeRecursive(tree, agent, rangeSq, tree.nodes[node].left);
 					}
 				}
 			}
@@ -321,7 +405,7 @@ namespace RVO {
 		}
 	}
 
-	void KdTree::queryObstacleTreeRecursive(Agent *agent, float rangeSq, const ObstacleTreeNode *node) const
+	void KdTree::queryObstacleTreeRecursive(Agent *agent, Real rangeSq, const ObstacleTreeNode *node) const
 	{
 		if (node == NULL) {
 			return;
@@ -330,11 +414,11 @@ namespace RVO {
 			const Obstacle *const obstacle1 = node->obstacle;
 			const Obstacle *const obstacle2 = obstacle1->nextObstacle_;
 
-			const float agentLeftOfLine = leftOf(obstacle1->point_, obstacle2->point_, agent->position_);
+			const Real agentLeftOfLine = leftOf(obstacle1->point_, obstacle2->point_, sim_->agentPositions_[agent->id_]);
 
 			queryObstacleTreeRecursive(agent, rangeSq, (agentLeftOfLine >= 0.0f ? node->left : node->right));
 
-			const float distSqLine = sqr(agentLeftOfLine) / absSq(obstacle2->point_ - obstacle1->point_);
+			const Real distSqLine = sqr(agentLeftOfLine) / absSq(obstacle2->point_ - obstacle1->point_);
 
 			if (distSqLine < rangeSq) {
 				if (agentLeftOfLine < 0.0f) {
@@ -352,12 +436,44 @@ namespace RVO {
 		}
 	}
 
-	bool KdTree::queryVisibility(const Vector2 &q1, const Vector2 &q2, float radius) const
+	void KdTree::queryObstacleCandidatesRecursive(Agent *agent, Real rangeSq, const ObstacleTreeNode *node) const
+	{
+		if (node == NULL) {
+			return;
+		}
+		else {
+			const Obstacle *const obstacle1 = node->obstacle;
+			const Obstacle *const obstacle2 = obstacle1->nextObstacle_;
+			const Vector2 &position = sim_->agentPositions_[agent->id_];
+
+			const Real agentLeftOfLine = leftOf(obstacle1->point_, obstacle2->point_, position);
+
+			queryObstacleCandidatesRecursive(agent, rangeSq, (agentLeftOfLine >= 0.0f ? node->left : node->right));
+
+			const Real distSqLine = sqr(agentLeftOfLine) / absSq(obstacle2->point_ - obstacle1->point_);
+
+			if (distSqLine < rangeSq) {
+				/*
+				 * Keep the obstacle even if the agent is on its left side, as the
+				 * agent may cross the line before the candidates are collected
+				 * again.
+				 */
+				if (distSqPointLineSegment(obstacle1->point_, obstacle2->point_, position) < rangeSq) {
+					agent->obstacleCandidates_.push_back(obstacle1);
+				}
+
+				/* Try other side of line. */
+				queryObstacleCandidatesRecursive(agent, rangeSq, (agentLeftOfLine >= 0.0f ? node->right : node->left));
+			}
+		}
+	}
+
+	bool KdTree::queryVisibility(const Vector2 &q1, const Vector2 &q2, Real radius) const
 	{
 		return queryVisibilityRecursive(q1, q2, radius, obstacleTree_);
 	}
 
-	bool KdTree::queryVisibilityRecursive(const Vector2 &q1, const Vector2 &q2, float radius, const ObstacleTreeNode *node) const
+	bool KdTree::queryVisibilityRecursive(const Vector2 &q1, const Vector2 &q2, Real radius, const ObstacleTreeNode *node) const
 	{
 		if (node == NULL) {
 			return true;
@@ -366,9 +482,9 @@ namespace RVO {
 			const Obstacle *const obstacle1 = node->obstacle;
 			const Obstacle *const obstacle2 = obstacle1->nextObstacle_;
 
-			const float q1LeftOfI = leftOf(obstacle1->point_, obstacle2->point_, q1);
-			const float q2LeftOfI = leftOf(obstacle1->point_, obstacle2->point_, q2);
-			const float invLengthI = 1.0f / absSq(obstacle2->point_ - obstacle1->point_);
+			const Real q1LeftOfI = leftOf(obstacle1->point_, obstacle2->point_, q1);
+			const Real q2LeftOfI = leftOf(obstacle1->point_, obstacle2->point_, q2);
+			const Real invLengthI = 1.0f / absSq(obstacle2->point_ - obstacle1->point_);
 
 			if (q1LeftOfI >= 0.0f && q2LeftOfI >= 0.0f) {
 				return queryVisibilityRecursive(q1, q2, radius, node->left) && ((sqr(q1LeftOfI) * invLengthI >= sqr(radius) && sqr(q2LeftOfI) * invLengthI >= sqr(radius)) || queryVisibilityRecursive(q1, q2, radius, node->right));
@@ -381,12 +497,115 @@ namespace RVO {
 				return queryVisibilityRecursive(q1, q2, radius, node->left) && queryVisibilityRecursive(q1, q2, radius, node->right);
 			}
 			else {
-				const float point1LeftOfQ = leftOf(q1, q2, obstacle1->point_);
-				const float point2LeftOfQ = leftOf(q1, q2, obstacle2->point_);
-				const float invLengthQ = 1.0f / absSq(q2 - q1);
+				const Real point1LeftOfQ = leftOf(q1, q2, obstacle1->point_);
+				const Real point2LeftOfQ = leftOf(q1, q2, obstacle2->point_);
+				const Real invLengthQ = 1.0f / absSq(q2 - q1);
 
 				return (point1LeftOfQ * point2LeftOfQ >= 0.0f && sqr(point1LeftOfQ) * invLengthQ > sqr(radius) && sqr(point2LeftOfQ) * invLengthQ > sqr(radius) && queryVisibilityRecursive(q1, q2, radius, node->left) && queryVisibilityRecursive(q1, q2, radius, node->right));
 			}
 		}
 	}
+
+	void KdTree::queryVisibility(const std::vector<Vector2> &points1, const std::vector<Vector2> &points2, Real radius, std::vector<bool> &visible) const
+	{
+		const size_t numQueries = std::min(points1.size(), points2.size());
+
+		/*
+		 * The queries of each node are kept in one buffer used as a stack, so
+		 * the traversal does not allocate per node.
+		 */
+		std::vector<size_t> queries;
+		queries.reserve(4 * numQueries);
+		queries.resize(numQueries);
+
+		for (size_t i = 0; i < numQueries; ++i) {
+			queries[i] = i;
+		}
+
+		visible.assign(numQueries, true);
+		queryVisibilityRecursive(points1, points2, radius, obstacleTree_, 0, numQueries, queries, visible);
+	}
+
+	void KdTree::queryVisibilityRecursive(const std::vector<Vector2> &points1, const std::vector<Vector2> &points2, Real radius, const ObstacleTreeNode *node, size_t begin, size_t end, std::vector<size_t> &queries, std::vector<bool> &visible) const
+	{
+		if (node == NULL || begin == end) {
+			return;
+		}
+
+		const Obstacle *const obstacle1 = node->obstacle;
+		const Obstacle *const obstacle2 = obstacle1->nextObstacle_;
+		const Real invLengthI = 1.0f / absSq(obstacle2->point_ - obstacle1->point_);
+
+		/*
+		 * Split the queries between the subtrees with the same case analysis as
+		 * the single query; a query is visible if it is not blocked in any
+		 * subtree it is sent to. Room for both lists is pushed on the buffer,
+		 * the left queries filling it from the front and the right queries from
+		 * the back.
+		 */
+		const size_t leftBegin = queries.size();
+		const size_t rightEnd = leftBegin + 2 * (end - begin);
+		size_t leftEnd = leftBegin;
+		size_t rightBegin = rightEnd;
+
+		queries.resize(rightEnd);
+
+		for (size_t i = begin; i < end; ++i) {
+			const size_t query = queries[i];
+			const Vector2 &q1 = points1[query];
+			const Vector2 &q2 = points2[query];
+
+			const Real q1LeftOfI = leftOf(obstacle1->point_, obstacle2->point_, q1);
+			const Real q2LeftOfI = leftOf(obstacle1->point_, obstacle2->point_, q2);
+			const bool clear = sqr(q1LeftOfI) * invLengthI >= sqr(radius) && sqr(q2LeftOfI) * invLengthI >= sqr(radius);
+
+			if (q1LeftOfI >= 0.0f && q2LeftOfI >= 0.0f) {
+				queries[leftEnd++] = query;
+
+				if (!clear) {
+					queries[--rightBegin] = query;
+				}
+			}
+			else if (q1LeftOfI <= 0.0f && q2LeftOfI <= 0.0f) {
+				queries[--rightBegin] = query;
+
+				if (!clear) {
+					queries[leftEnd++] = query;
+				}
+			}
+			else if (q1LeftOfI >= 0.0f && q2LeftOfI <= 0.0f) {
+				/* One can see through obstacle from left to right. */
+				queries[leftEnd++] = query;
+				queries[--rightBegin] = query;
+			}
+			else {
+				const Real point1LeftOfQ = leftOf(q1, q2, obstacle1->point_);
+				const Real point2LeftOfQ = leftOf(q1, q2, obstacle2->point_);
+				const Real invLengthQ = 1.0f / absSq(q2 - q1);
+
+				if (point1LeftOfQ * point2LeftOfQ >= 0.0f && sqr(point1LeftOfQ) * invLengthQ > sqr(radius) && sqr(point2LeftOfQ) * invLengthQ > sqr(radius)) {
+					queries[leftEnd++] = query;
+					queries[--rightBegin] = query;
+				}
+				else {
+					visible[query] = false;
+				}
+			}
+		}
+
+		queryVisibilityRecursive(points1, points2, radius, node->left, leftBegin, leftEnd, queries, visible);
+		queries.resize(rightEnd);
+
+		/* Skip the queries already blocked in the left subtree. */
+		size_t numRightQueries = rightBegin;
+
+		for (size_t i = rightBegin; i < rightEnd; ++i) {
+			if (visible[queries[i]]) {
+				queries[numRightQueries++] = queries[i];
+			}
+		}
+
+		queryVisibilityRecursive(points1, points2, radius, node->right, rightBegin, numRightQueries, queries, visible);
+		queries.resize(leftBegin);
+	}
 }
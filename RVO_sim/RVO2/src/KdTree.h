@@ -62,6 +62,7 @@
  * \brief      Contains the KdTree class.
  */
 
+#include "Arena.h"
 #include "Definitions.h"
 
 namespace RVO {
@@ -94,22 +95,22 @@ namespace RVO {
 			/**
 			 * \brief      The maximum x-coordinate.
 			 */
-			float maxX;
+			Real maxX;
 
 			/**
 			 * \brief      The maximum y-coordinate.
 			 */
-			float maxY;
+			Real maxY;
 
 			/**
 			 * \brief      The minimum x-coordinate.
 			 */
-			float minX;
+			Real minX;
 
 			/**
 			 * \brief      The minimum y-coordinate.
 			 */
-			float minY;
+			Real minY;
 
 			/**
 			 * \brief      The right node number.
@@ -117,6 +118,28 @@ namespace RVO {
 			size_t right;
 		};
 
+		/**
+		 * \brief      Defines an agent <i>k</i>d-tree over a subset of the
+		 *             agents.
+		 */
+		class AgentTree {
+		public:
+			/**
+			 * \brief      The agents in tree order.
+			 */
+			std::vector<Agent *> agents;
+
+			/**
+			 * \brief      The nodes of the tree.
+			 */
+			std::vector<AgentTreeNode> nodes;
+
+			/**
+			 * \brief      The positions of the agents in tree order.
+			 */
+			std::vector<Vector2> positions;
+		};
+
 		/**
 		 * \brief      Defines an obstacle <i>k</i>d-tree node.
 		 */
@@ -150,11 +173,21 @@ namespace RVO {
 		~KdTree();
 
 		/**
-		 * \brief      Builds an agent <i>k</i>d-tree.
+		 * \brief      Builds an agent <i>k</i>d-tree of the active agents, after
+		 *             sorting the agents into the active and the dormant tree
+		 *             again if they were added or changed their state.
 		 */
 		void buildAgentTree();
 
-		void buildAgentTreeRecursive(size_t begin, size_t end, size_t node);
+		/**
+		 * \brief      Builds a specified agent <i>k</i>d-tree from the present
+		 *             positions of its agents.
+		 * \param      tree            The agent <i>k</i>d-tree to be built.
+		 */
+		void buildAgentTree(AgentTree &tree);
+
+		void buildAgentTreeRecursive(AgentTree &tree, size_t begin, size_t end,
+									 size_t node);
 
 		/**
 		 * \brief      Builds an obstacle <i>k</i>d-tree.
@@ -164,13 +197,22 @@ namespace RVO {
 		ObstacleTreeNode *buildObstacleTreeRecursive(const std::vector<Obstacle *> &
 													 obstacles);
 
+		/**
+		 * \brief      Collects all agents within a specified range of the
+		 *             specified agent as its agent neighbor candidates.
+		 * \param      agent           A pointer to the agent for which agent
+		 *                             candidates are to be collected.
+		 * \param      rangeSq         The squared range around the agent.
+		 */
+		void computeAgentCandidates(Agent *agent, Real rangeSq) const;
+
 		/**
 		 * \brief      Computes the agent neighbors of the specified agent.
 		 * \param      agent           A pointer to the agent for which agent
 		 *                             neighbors are to be computed.
 		 * \param      rangeSq         The squared range around the agent.
 		 */
-		void computeAgentNeighbors(Agent *agent, float &rangeSq) const;
+		void computeAgentNeighbors(Agent *agent, Real &rangeSq) const;
 
 		/**
 		 * \brief      Computes the obstacle neighbors of the specified agent.
@@ -178,19 +220,28 @@ namespace RVO {
 		 *                             neighbors are to be computed.
 		 * \param      rangeSq         The squared range around the agent.
 		 */
-		void computeObstacleNeighbors(Agent *agent, float rangeSq) const;
+		void computeObstacleNeighbors(Agent *agent, Real rangeSq) const;
 
 		/**
-		 * \brief      Deletes the specified obstacle tree node.
-		 * \param      node            A pointer to the obstacle tree node to be
-		 *                             deleted.
+		 * \brief      Collects all obstacles within a specified range of the
+		 *             specified agent as its obstacle neighbor candidates,
+		 *             regardless of the side of the obstacle the agent is on.
+		 * \param      agent           A pointer to the agent for which obstacle
+		 *                             candidates are to be collected.
+		 * \param      rangeSq         The squared range around the agent.
 		 */
-		void deleteObstacleTree(ObstacleTreeNode *node);
+		void computeObstacleCandidates(Agent *agent, Real rangeSq) const;
+
+		void queryAgentCandidatesRecursive(const AgentTree &tree, Agent *agent,
+										   Real rangeSq, size_t node) const;
 
-		void queryAgentTreeRecursive(Agent *agent, float &rangeSq,
-									 size_t node) const;
+		void queryObstacleCandidatesRecursive(Agent *agent, Real rangeSq,
+											  const ObstacleTreeNode *node) const;
 
-		void queryObstacleTreeRecursive(Agent *agent, float rangeSq,
+		void queryAgentTreeRecursive(const AgentTree &tree, Agent *agent,
+									 Real &rangeSq, size_t node) const;
+
+		void queryObstacleTreeRecursive(Agent *agent, Real rangeSq,
 										const ObstacleTreeNode *node) const;
 
 		/**
@@ -206,15 +257,40 @@ namespace RVO {
 		 *             false otherwise.
 		 */
 		bool queryVisibility(const Vector2 &q1, const Vector2 &q2,
-							 float radius) const;
+							 Real radius) const;
 
 		bool queryVisibilityRecursive(const Vector2 &q1, const Vector2 &q2,
-									  float radius,
+									  Real radius,
 									  const ObstacleTreeNode *node) const;
 
-		std::vector<Agent *> agents_;
-		std::vector<AgentTreeNode> agentTree_;
+		/**
+		 * \brief      Queries the visibility between many pairs of points
+		 *             within a specified radius in a single traversal of the
+		 *             obstacle tree.
+		 * \param      points1         The first points of the queries.
+		 * \param      points2         The second points of the queries.
+		 * \param      radius          The radius within which visibility is to be
+		 *                             tested.
+		 * \param      visible         Receives for each query whether the two
+		 *                             points are mutually visible.
+		 */
+		void queryVisibility(const std::vector<Vector2> &points1,
+							 const std::vector<Vector2> &points2, Real radius,
+							 std::vector<bool> &visible) const;
+
+		void queryVisibilityRecursive(const std::vector<Vector2> &points1,
+									  const std::vector<Vector2> &points2,
+									  Real radius,
+									  const ObstacleTreeNode *node,
+									  size_t begin, size_t end,
+									  std::vector<size_t> &queries,
+									  std::vector<bool> &visible) const;
+
+		AgentTree agentTree_;
+		AgentTree dormantAgentTree_;
+		size_t numAgents_;
 		ObstacleTreeNode *obstacleTree_;
+		Arena<ObstacleTreeNode> obstacleTreeNodes_;
 		RVOSimulator *sim_;
 
 		static const size_t MAX_LEAF_SIZE = 10;
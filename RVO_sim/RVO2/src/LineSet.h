@@ -0,0 +1,220 @@
+/*
+ * LineSet.h
+ * RVO2 Library
+ *
+ * Copyright (c) 2008-2010 University of North Carolina at Chapel Hill.
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation for educational, research, and non-profit purposes, without
+ * fee, and without a written agreement is hereby granted, provided that the
+ * above copyright notice, this paragraph, and the following four paragraphs
+ * appear in all copies.
+ *
+ * Permission to incorporate this software into commercial products may be
+ * obtained by contacting the authors <geom@cs.unc.edu> or the Office of
+ * Technology Development at the University of North Carolina at Chapel Hill
+ * <otd@unc.edu>.
+ *
+ * This software program and documentation are copyrighted by the University of
+ * North Carolina at Chapel Hill. The software program and documentation are
+ * supplied "as is," without any accompanying services from the University of
+ * North Carolina at Chapel Hill or the authors. The University of North
+ * Carolina at Chapel Hill and the authors do not warrant that the operation of
+ * the program will be uninterrupted or error-free. The end-user understands
+ * that the program was developed for research purposes and is advised not to
+ * rely exclusively on the program for any reason.
+ *
+ * IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE
+ * AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR
+ * CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS
+ * SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE UNIVERSITY OF NORTH CAROLINA AT
+ * CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ * DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ * STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS ON
+ * AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE
+ * AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ *
+ * Please send all bug reports to <geom@cs.unc.edu>.
+ *
+ * The authors may be contacted via:
+ *
+ * Jur van den Berg, Stephen J. Guy, Jamie Snape, Ming C. Lin, Dinesh Manocha
+ * Dept. of Computer Science
+ * 201 S. Columbia St.
+ * Frederick P. Brooks, Jr. Computer Science Bldg.
+ * Chapel Hill, N.C. 27599-3175
+ * United States of America
+ *
+ * <http://gamma.cs.unc.edu/RVO2/>
+ */
+
+
+#ifndef RVO_LINE_SET_H_
+#define RVO_LINE_SET_H_
+
+/**
+ * \file       LineSet.h
+ * \brief      Contains the LineSet class.
+ */
+
+#include <cstddef>
+#include <vector>
+
+#include "RVOSimulator.h"
+
+namespace RVO {
+	/**
+	 * \brief      Defines a set of directed lines stored as separate arrays of
+	 *             coordinates, so that the linear programs can test several
+	 *             lines at once.
+	 *
+	 * As with NeighborSet, the storage grows to the largest size ever used and
+	 * is reused from then on.
+	 */
+	class LineSet {
+	public:
+		/**
+		 * \brief      Constructs an empty line set.
+		 */
+		LineSet() : size_(0) { }
+
+		/**
+		 * \brief      Replaces the lines of the set with the first lines of a
+		 *             specified set.
+		 * \param      lines           The set whose lines are to be copied.
+		 * \param      count           The number of lines to be copied.
+		 */
+		void assign(const LineSet &lines, size_t count)
+		{
+			reserve(count);
+
+			for (size_t i = 0; i < count; ++i) {
+				directionX_[i] = lines.directionX_[i];
+				directionY_[i] = lines.directionY_[i];
+				pointX_[i] = lines.pointX_[i];
+				pointY_[i] = lines.pointY_[i];
+			}
+
+			size_ = count;
+		}
+
+		/**
+		 * \brief      Replaces the lines of the set with the specified lines.
+		 * \param      lines           The lines to be copied.
+		 */
+		void assign(const std::vector<Line> &lines)
+		{
+			reserve(lines.size());
+
+			for (size_t i = 0; i < lines.size(); ++i) {
+				directionX_[i] = lines[i].direction.x();
+				directionY_[i] = lines[i].direction.y();
+				pointX_[i] = lines[i].point.x();
+				pointY_[i] = lines[i].point.y();
+			}
+
+			size_ = lines.size();
+		}
+
+		/**
+		 * \brief      Returns the x-coordinates of the directions of the lines.
+		 * \return     An array of size() x-coordinates.
+		 */
+		const Real *directionX() const
+		{
+			return directionX_.empty() ? NULL : &directionX_[0];
+		}
+
+		/**
+		 * \brief      Returns the y-coordinates of the directions of the lines.
+		 * \return     An array of size() y-coordinates.
+		 */
+		const Real *directionY() const
+		{
+			return directionY_.empty() ? NULL : &directionY_[0];
+		}
+
+		/**
+		 * \brief      Returns the x-coordinates of the points on the lines.
+		 * \return     An array of size() x-coordinates.
+		 */
+		const Real *pointX() const
+		{
+			return pointX_.empty() ? NULL : &pointX_[0];
+		}
+
+		/**
+		 * \brief      Returns the y-coordinates of the points on the lines.
+		 * \return     An array of size() y-coordinates.
+		 */
+		const Real *pointY() const
+		{
+			return pointY_.empty() ? NULL : &pointY_[0];
+		}
+
+		/**
+		 * \brief      Appends a line to the set.
+		 * \param      line            The line to be appended.
+		 */
+		void push_back(const Line &line)
+		{
+			if (size_ == directionX_.size()) {
+				reserve(directionX_.empty() ? 16 : 2 * directionX_.size());
+			}
+
+			directionX_[size_] = line.direction.x();
+			directionY_[size_] = line.direction.y();
+			pointX_[size_] = line.point.x();
+			pointY_[size_] = line.point.y();
+			++size_;
+		}
+
+		/**
+		 * \brief      Returns the number of lines in the set.
+		 * \return     The number of lines in the set.
+		 */
+		size_t size() const
+		{
+			return size_;
+		}
+
+		/**
+		 * \brief      Returns the specified line.
+		 * \param      i               The number of the line.
+		 * \return     A copy of the line.
+		 */
+		Line operator[](size_t i) const
+		{
+			Line line;
+			line.direction = Vector2(directionX_[i], directionY_[i]);
+			line.point = Vector2(pointX_[i], pointY_[i]);
+
+			return line;
+		}
+
+	private:
+		void reserve(size_t count)
+		{
+			if (count > directionX_.size()) {
+				directionX_.resize(count);
+				directionY_.resize(count);
+				pointX_.resize(count);
+				pointY_.resize(count);
+			}
+		}
+
+		std::vector<Real> directionX_;
+		std::vector<Real> directionY_;
+		std::vector<Real> pointX_;
+		std::vector<Real> pointY_;
+		size_t size_;
+	};
+}
+
+#endif /* RVO_LINE_SET_H_ */
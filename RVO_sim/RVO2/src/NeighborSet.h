@@ -0,0 +1,187 @@
+/*
+ * NeighborSet.h
+ * RVO2 Library
+ *
+ * Copyright (c) 2008-2010 University of North Carolina at Chapel Hill.
+ * All rights reserved.
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation for educational, research, and non-profit purposes, without
+ * fee, and without a written agreement is hereby granted, provided that the
+ * above copyright notice, this paragraph, and the following four paragraphs
+ * appear in all copies.
+ *
+ * Permission to incorporate this software into commercial products may be
+ * obtained by contacting the authors <geom@cs.unc.edu> or the Office of
+ * Technology Development at the University of North Carolina at Chapel Hill
+ * <otd@unc.edu>.
+ *
+ * This software program and documentation are copyrighted by the University of
+ * North Carolina at Chapel Hill. The software program and documentation are
+ * supplied "as is," without any accompanying services from the University of
+ * North Carolina at Chapel Hill or the authors. The University of North
+ * Carolina at Chapel Hill and the authors do not warrant that the operation of
+ * the program will be uninterrupted or error-free. The end-user understands
+ * that the program was developed for research purposes and is advised not to
+ * rely exclusively on the program for any reason.
+ *
+ * IN NO EVENT SHALL THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL OR THE
+ * AUTHORS BE LIABLE TO ANY PARTY FOR DIRECT, INDIRECT, SPECIAL, INCIDENTAL, OR
+ * CONSEQUENTIAL DAMAGES, INCLUDING LOST PROFITS, ARISING OUT OF THE USE OF THIS
+ * SOFTWARE AND ITS DOCUMENTATION, EVEN IF THE UNIVERSITY OF NORTH CAROLINA AT
+ * CHAPEL HILL OR THE AUTHORS HAVE BEEN ADVISED OF THE POSSIBILITY OF SUCH
+ * DAMAGE.
+ *
+ * THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE AUTHORS SPECIFICALLY
+ * DISCLAIM ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE AND ANY
+ * STATUTORY WARRANTY OF NON-INFRINGEMENT. THE SOFTWARE PROVIDED HEREUNDER IS ON
+ * AN "AS IS" BASIS, AND THE UNIVERSITY OF NORTH CAROLINA AT CHAPEL HILL AND THE
+ * AUTHORS HAVE NO OBLIGATIONS TO PROVIDE MAINTENANCE, SUPPORT, UPDATES,
+ * ENHANCEMENTS, OR MODIFICATIONS.
+ *
+ * Please send all bug reports to <geom@cs.unc.edu>.
+ *
+ * The authors may be contacted via:
+ *
+ * Jur van den Berg, Stephen J. Guy, Jamie Snape, Ming C. Lin, Dinesh Manocha
+ * Dept. of Computer Science
+ * 201 S. Columbia St.
+ * Frederick P. Brooks, Jr. Computer Science Bldg.
+ * Chapel Hill, N.C. 27599-3175
+ * United States of America
+ *
+ * <http://gamma.cs.unc.edu/RVO2/>
+ */
+
+#ifndef RVO_NEIGHBOR_SET_H_
+#define RVO_NEIGHBOR_SET_H_
+
+/**
+ * \file       NeighborSet.h
+ * \brief      Contains the NeighborSet class.
+ */
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "Vector2.h"
+
+namespace RVO {
+	/**
+	 * \brief      Defines a bounded set of neighbors sorted by increasing
+	 *             squared distance.
+	 *
+	 * A bounded set allocates room for its maximum number of neighbors when it
+	 * is reset and never grows past it. An unbounded set, such as that of the
+	 * obstacle neighbors, grows to the largest size ever used. Either way the
+	 * storage is reused, so clearing and refilling the set on every simulation
+	 * step does not allocate in steady state.
+	 */
+	template <class T>
+	class NeighborSet {
+	public:
+		/**
+		 * \brief      Constructs an empty, unbounded neighbor set.
+		 */
+		NeighborSet() : maxSize_(std::numeric_limits<size_t>::max()), size_(0) { }
+
+		/**
+		 * \brief      Returns the neighbor with the largest squared distance.
+		 * \return     The farthest neighbor in the set.
+		 */
+		const std::pair<Real, T> &back() const
+		{
+			return entries_[size_ - 1];
+		}
+
+		/**
+		 * \brief      Returns whether the set holds its maximum number of
+		 *             neighbors.
+		 * \return     True if no neighbor can be added without dropping the
+		 *             farthest one.
+		 */
+		bool full() const
+		{
+			return size_ == maxSize_;
+		}
+
+		/**
+		 * \brief      Inserts a neighbor, keeping the set sorted. If the set
+		 *             is full, the farthest neighbor is dropped.
+		 * \param      distSq          The squared distance to the neighbor.
+		 *                             Must be smaller than that of the farthest
+		 *                             neighbor when the set is full.
+		 * \param      value           The neighbor to be inserted.
+		 */
+		void insert(Real distSq, const T &value)
+		{
+			/* Neighbors at equal distance keep their insertion order. */
+			size_t pos = 0;
+
+			for (size_t i = 0; i < size_; ++i) {
+				pos += (entries_[i].first <= distSq);
+			}
+
+			if (size_ < maxSize_) {
+				/* Only unbounded sets run out of room. */
+				if (size_ == entries_.size()) {
+					entries_.resize(entries_.empty() ? 16 : 2 * entries_.size());
+				}
+
+				++size_;
+			}
+
+			for (size_t i = size_ - 1; i > pos; --i) {
+				entries_[i] = entries_[i - 1];
+			}
+
+			entries_[pos] = std::make_pair(distSq, value);
+		}
+
+		/**
+		 * \brief      Removes all neighbors and sets the maximum number of
+		 *             neighbors.
+		 * \param      maxSize         The maximum number of neighbors (optional).
+		 *                             Unbounded by default.
+		 */
+		void reset(size_t maxSize = std::numeric_limits<size_t>::max())
+		{
+			if (maxSize != std::numeric_limits<size_t>::max() && entries_.size() < maxSize) {
+				entries_.resize(maxSize);
+			}
+
+			maxSize_ = maxSize;
+			size_ = 0;
+		}
+
+		/**
+		 * \brief      Returns the number of neighbors in the set.
+		 * \return     The number of neighbors in the set.
+		 */
+		size_t size() const
+		{
+			return size_;
+		}
+
+		/**
+		 * \brief      Returns the specified neighbor.
+		 * \param      i               The number of the neighbor, in order of
+		 *                             increasing squared distance.
+		 * \return     A pair of the squared distance and the neighbor.
+		 */
+		const std::pair<Real, T> &operator[](size_t i) const
+		{
+			return entries_[i];
+		}
+
+	private:
+		std::vector<std::pair<Real, T> > entries_;
+		size_t maxSize_;
+		size_t size_;
+	};
+}
+
+#endif /* RVO_NEIGHBOR_SET_H_ */
@@ -195,6 +195,16 @@
  and a static library <tt>libRVO.a</tt> will be compiled into the
  <tt>$RVO_ROOT/lib</tt> directory.
 
+ \section    precision   Precision
+
+ The scalar type <tt>RVO::Real</tt> used throughout the library is
+ <tt>float</tt> by default. Defining <tt>RVO_DOUBLE_PRECISION</tt> when
+ compiling both the library and the program using it makes it
+ <tt>double</tt>, for long simulations where accuracy matters more than
+ throughput. <tt>make</tt> builds this variant as <tt>libRVOd.a</tt> next to
+ <tt>libRVO.a</tt>, and CMake as the <tt>RVOd</tt> target. The SIMD solver
+ paths are only used in single precision.
+
  \section    visual      Microsoft Visual Studio 2008
 
  Open <tt>$RVO_ROOT/RVO.sln</tt> and select the <tt>%RVO</tt> project and a
@@ -427,7 +437,7 @@
  </tr>
  <tr>
  <td valign="top">timeStep</td>
- <td valign="top">float (time)</td>
+ <td valign="top">Real (time)</td>
  <td valign="top">The time step of the simulation. Must be positive.</td>
  </tr>
  </table>
@@ -450,12 +460,12 @@
  </tr>
  <tr>
  <td valign="top">maxSpeed</td>
- <td valign="top">float (distance/time)</td>
+ <td valign="top">Real (distance/time)</td>
  <td valign="top">The maximum speed of the agent. Must be non-negative.</td>
  </tr>
  <tr>
  <td valign="top">neighborDist</td>
- <td valign="top">float (distance)</td>
+ <td valign="top">Real (distance)</td>
  <td valign="top">The maximum distance (center point to center point) to
  other agents the agent takes into account in the
  navigation. The larger this number, the longer the running
@@ -480,12 +490,12 @@
  </tr>
  <tr>
  <td valign="top">radius</td>
- <td valign="top">float (distance)</td>
+ <td valign="top">Real (distance)</td>
  <td valign="top">The radius of the agent. Must be non-negative.</td>
  </tr>
  <tr>
  <td valign="top" width="150">timeHorizon</td>
- <td valign="top" width="150">float (time)</td>
+ <td valign="top" width="150">Real (time)</td>
  <td valign="top">The minimal amount of time for which the agent's velocities
  that are computed by the simulation are safe with respect
  to other agents. The larger this number, the sooner this
@@ -495,7 +505,7 @@
  </tr>
  <tr>
  <td valign="top">timeHorizonObst</td>
- <td valign="top">float (time)</td>
+ <td valign="top">Real (time)</td>
  <td valign="top">The minimal amount of time for which the agent's velocities
  that are computed by the simulation are safe with respect
  to obstacles. The larger this number, the sooner this agent
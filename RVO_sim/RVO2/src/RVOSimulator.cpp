@@ -56,7 +56,12 @@
 
 #include "RVOSimulator.h"
 
+#include <algorithm>
+#include <new>
+
 #include "Agent.h"
+#include "AgentGrid.h"
+#include "Arena.h"
 #include "KdTree.h"
 #include "Obstacle.h"
 
@@ -65,14 +70,20 @@
 #endif
 
 namespace RVO {
-	RVOSimulator::RVOSimulator() : defaultAgent_(NULL), globalTime_(0.0f), kdTree_(NULL), timeStep_(0.0f)
+	RVOSimulator::RVOSimulator() : agentArena_(NULL), defaultAgent_(NULL), detailMargin_(0.0f), detailStep_(0), dormantAgentsChanged_(false), globalTime_(0.0f), kdTree_(NULL), lowDetailAgentsChanged_(false), lowDetailGrid_(NULL), lowDetailInterval_(4), lowDetailStep_(0), maxAgentSpeed_(0.0f), maxNeighborDist_(0.0f), neighborSkin_(0.0f), obstacleArena_(NULL), rebuildNeighborLists_(true), timeStep_(0.0f)
 	{
+		agentArena_ = new Arena<Agent>();
 		kdTree_ = new KdTree(this);
+		lowDetailGrid_ = new AgentGrid();
+		obstacleArena_ = new Arena<Obstacle>();
 	}
 
-	RVOSimulator::RVOSimulator(float timeStep, float neighborDist, size_t maxNeighbors, float timeHorizon, float timeHorizonObst, float radius, float maxSpeed, const Vector2 &velocity) : defaultAgent_(NULL), globalTime_(0.0f), kdTree_(NULL), timeStep_(timeStep)
+	RVOSimulator::RVOSimulator(Real timeStep, Real neighborDist, size_t maxNeighbors, Real timeHorizon, Real timeHorizonObst, Real radius, Real maxSpeed, const Vector2 &velocity) : agentArena_(NULL), defaultAgent_(NULL), detailMargin_(0.0f), detailStep_(0), dormantAgentsChanged_(false), globalTime_(0.0f), kdTree_(NULL), lowDetailAgentsChanged_(false), lowDetailGrid_(NULL), lowDetailInterval_(4), lowDetailStep_(0), maxAgentSpeed_(0.0f), maxNeighborDist_(0.0f), neighborSkin_(0.0f), obstacleArena_(NULL), rebuildNeighborLists_(true), timeStep_(timeStep)
 	{
+		agentArena_ = new Arena<Agent>();
 		kdTree_ = new KdTree(this);
+		lowDetailGrid_ = new AgentGrid();
+		obstacleArena_ = new Arena<Obstacle>();
 		defaultAgent_ = new Agent(this);
 
 		defaultAgent_->maxNeighbors_ = maxNeighbors;
@@ -81,7 +92,7 @@ namespace RVO {
 		defaultAgent_->radius_ = radius;
 		defaultAgent_->timeHorizon_ = timeHorizon;
 		defaultAgent_->timeHorizonObst_ = timeHorizonObst;
-		defaultAgent_->velocity_ = velocity;
+		defaultVelocity_ = velocity;
 	}
 
 	RVOSimulator::~RVOSimulator()
@@ -90,15 +101,14 @@ namespace RVO {
 			delete defaultAgent_;
 		}
 
-		for (size_t i = 0; i < agents_.size(); ++i) {
-			delete agents_[i];
-		}
-
-		for (size_t i = 0; i < obstacles_.size(); ++i) {
-			delete obstacles_[i];
+		for (size_t i = 0; i < scratch_.size(); ++i) {
+			delete scratch_[i];
 		}
 
 		delete kdTree_;
+		delete lowDetailGrid_;
+		delete agentArena_;
+		delete obstacleArena_;
 	}
 
 	size_t RVOSimulator::addAgent(const Vector2 &position)
@@ -107,44 +117,161 @@ namespace RVO {
 			return RVO_ERROR;
 		}
 
-		Agent *agent = new Agent(this);
+		Agent *agent = new (agentArena_->allocate()) Agent(this);
 
-		agent->position_ = position;
 		agent->maxNeighbors_ = defaultAgent_->maxNeighbors_;
 		agent->maxSpeed_ = defaultAgent_->maxSpeed_;
 		agent->neighborDist_ = defaultAgent_->neighborDist_;
 		agent->radius_ = defaultAgent_->radius_;
 		agent->timeHorizon_ = defaultAgent_->timeHorizon_;
 		agent->timeHorizonObst_ = defaultAgent_->timeHorizonObst_;
-		agent->velocity_ = defaultAgent_->velocity_;
 
 		agent->id_ = agents_.size();
 
+		activeAgents_.push_back(agent);
 		agents_.push_back(agent);
+		agentNewVelocities_.push_back(Vector2());
+		agentPositions_.push_back(position);
+		agentPrefVelocities_.push_back(Vector2());
+		agentVelocities_.push_back(defaultVelocity_);
+
+		addToNeighborLists(agent);
 
 		return agents_.size() - 1;
 	}
 
-	size_t RVOSimulator::addAgent(const Vector2 &position, float neighborDist, size_t maxNeighbors, float timeHorizon, float timeHorizonObst, float radius, float maxSpeed, const Vector2 &velocity)
+	size_t RVOSimulator::addAgent(const Vector2 &position, Real neighborDist, size_t maxNeighbors, Real timeHorizon, Real timeHorizonObst, Real radius, Real maxSpeed, const Vector2 &velocity)
 	{
-		Agent *agent = new Agent(this);
+		Agent *agent = new (agentArena_->allocate()) Agent(this);
 
-		agent->position_ = position;
 		agent->maxNeighbors_ = maxNeighbors;
 		agent->maxSpeed_ = maxSpeed;
 		agent->neighborDist_ = neighborDist;
 		agent->radius_ = radius;
 		agent->timeHorizon_ = timeHorizon;
 		agent->timeHorizonObst_ = timeHorizonObst;
-		agent->velocity_ = velocity;
 
 		agent->id_ = agents_.size();
 
+		activeAgents_.push_back(agent);
 		agents_.push_back(agent);
+		agentNewVelocities_.push_back(Vector2());
+		agentPositions_.push_back(position);
+		agentPrefVelocities_.push_back(Vector2());
+		agentVelocities_.push_back(velocity);
+
+		addToNeighborLists(agent);
 
 		return agents_.size() - 1;
 	}
 
+	void RVOSimulator::addToNeighborLists(Agent *agent)
+	{
+		maxNeighborDist_ = std::max(maxNeighborDist_, agent->neighborDist_);
+
+		if (neighborSkin_ == 0.0f) {
+			if (agent->maxSpeed_ > maxAgentSpeed_) {
+				/* The free flight of all agents was bounded by a lower speed. */
+				rebuildNeighborLists_ = true;
+				return;
+			}
+
+			if (rebuildNeighborLists_) {
+				return;
+			}
+
+			/*
+			 * Agents in free flight that the new agent may reach search again.
+			 * The trees hold the positions at the start of the last step, and
+			 * agents added since then are not in free flight yet. Without a
+			 * skin the candidates of the new agent are unused, so they collect
+			 * the agents found.
+			 */
+			const Vector2 &position = agentPositions_[agent->id_];
+
+			kdTree_->computeAgentCandidates(agent, sqr(2.0f * maxNeighborDist_ + maxAgentSpeed_ * timeStep_));
+
+			for (size_t i = 0; i < agent->agentCandidates_.size(); ++i) {
+				Agent *const other = agents_[agent->agentCandidates_[i]->id_];
+
+				if (other->freeFlightSteps_ > 0 && absSq(position - agentPositions_[other->id_]) < sqr(2.0f * other->neighborDist_)) {
+					other->freeFlightSteps_ = 0;
+				}
+			}
+
+			agent->agentCandidates_.clear();
+
+			return;
+		}
+
+		if (rebuildNeighborLists_) {
+			return;
+		}
+
+		/*
+		 * Rather than rebuilding all neighbor lists, give the new agent its own
+		 * candidates and add it to the candidates of the other agents, measured
+		 * from the positions at which their lists were built.
+		 */
+		const Vector2 &position = agentPositions_[agent->id_];
+		neighborListPositions_.push_back(position);
+
+		kdTree_->computeObstacleCandidates(agent, sqr(agent->timeHorizonObst_ * agent->maxSpeed_ + agent->radius_ + neighborSkin_));
+
+		agent->agentCandidateRangeSq_ = sqr(agent->neighborDist_ + neighborSkin_);
+
+		/*
+		 * The trees were built from the positions at which the lists were
+		 * built, so they find every agent whose candidates may take the new
+		 * agent, and every candidate of the new agent.
+		 */
+		kdTree_->computeAgentCandidates(agent, sqr(maxNeighborDist_ + neighborSkin_));
+
+		size_t numCandidates = 0;
+
+		for (size_t i = 0; i < agent->agentCandidates_.size(); ++i) {
+			Agent *const other = agents_[agent->agentCandidates_[i]->id_];
+			const Real distSq = absSq(position - neighborListPositions_[other->id_]);
+
+			if (agent->maxNeighbors_ > 0 && distSq < agent->agentCandidateRangeSq_) {
+				agent->agentCandidates_[numCandidates++] = other;
+			}
+
+			if (other->maxNeighbors_ > 0 && distSq < other->agentCandidateRangeSq_) {
+				other->agentCandidates_.push_back(agent);
+			}
+		}
+
+		agent->agentCandidates_.resize(numCandidates);
+
+		/* Agents added since the trees were built are not in them. */
+		for (size_t i = kdTree_->numAgents_; i < agent->id_; ++i) {
+			const Real distSq = absSq(position - neighborListPositions_[i]);
+
+			if (agent->maxNeighbors_ > 0 && distSq < agent->agentCandidateRangeSq_) {
+				agent->agentCandidates_.push_back(agents_[i]);
+			}
+
+			if (agents_[i]->maxNeighbors_ > 0 && distSq < agents_[i]->agentCandidateRangeSq_) {
+				agents_[i]->agentCandidates_.push_back(agent);
+			}
+		}
+	}
+
+	size_t RVOSimulator::addDetailRegion(const std::vector<Vector2> &vertices)
+	{
+		if (vertices.size() < 3) {
+			return RVO_ERROR;
+		}
+
+		detailRegions_.push_back(vertices);
+
+		/* Classify the agents against the new region on the next step. */
+		detailStep_ = 0;
+
+		return detailRegions_.size() - 1;
+	}
+
 	size_t RVOSimulator::addObstacle(const std::vector<Vector2> &vertices)
 	{
 		if (vertices.size() < 2) {
@@ -154,7 +281,7 @@ namespace RVO {
 		const size_t obstacleNo = obstacles_.size();
 
 		for (size_t i = 0; i < vertices.size(); ++i) {
-			Obstacle *obstacle = new Obstacle();
+			Obstacle *obstacle = new (obstacleArena_->allocate()) Obstacle();
 			obstacle->point_ = vertices[i];
 
 			if (i != 0) {
@@ -186,21 +313,178 @@ namespace RVO {
 
 	void RVOSimulator::doStep()
 	{
-		kdTree_->buildAgentTree();
+		if (neighborSkin_ > 0.0f && !rebuildNeighborLists_) {
+			/*
+			 * The neighbor lists stay complete while no agent has moved more
+			 * than half the skin since they were built.
+			 */
+			const Real maxDisplacementSq = sqr(0.5f * neighborSkin_);
+
+			for (size_t i = 0; i < agentPositions_.size(); ++i) {
+				if (absSq(agentPositions_[i] - neighborListPositions_[i]) > maxDisplacementSq) {
+					rebuildNeighborLists_ = true;
+					break;
+				}
+			}
+		}
+
+		if (!detailRegions_.empty()) {
+			/* The agents are classified once every low-detail interval. */
+			if (detailStep_ % lowDetailInterval_ == 0) {
+				updateLevelsOfDetail();
+			}
+
+			++detailStep_;
+		}
+
+		if (dormantAgentsChanged_ || lowDetailAgentsChanged_) {
+			activeAgents_.clear();
+			lowDetailAgents_.clear();
+
+			for (size_t i = 0; i < agents_.size(); ++i) {
+				if (!agents_[i]->dormant_) {
+					(agents_[i]->lowDetail_ ? lowDetailAgents_ : activeAgents_).push_back(agents_[i]);
+				}
+			}
+
+			lowDetailAgentsChanged_ = false;
+		}
+
+		if (neighborSkin_ == 0.0f || rebuildNeighborLists_) {
+			kdTree_->buildAgentTree();
+			dormantAgentsChanged_ = false;
+		}
+
+		if (neighborSkin_ > 0.0f && rebuildNeighborLists_) {
+			neighborListPositions_ = agentPositions_;
+		}
+
+		maxAgentSpeed_ = 0.0f;
+
+		for (size_t i = 0; i < activeAgents_.size(); ++i) {
+			maxAgentSpeed_ = std::max(maxAgentSpeed_, activeAgents_[i]->maxSpeed_);
+		}
+
+		for (size_t i = 0; i < lowDetailAgents_.size(); ++i) {
+			maxAgentSpeed_ = std::max(maxAgentSpeed_, lowDetailAgents_[i]->maxSpeed_);
+		}
+
+		agentFreeFlight_.resize(agents_.size());
+
+#ifdef _OPENMP
+		const size_t numThreads = static_cast<size_t>(omp_get_max_threads());
+#else
+		const size_t numThreads = 1;
+#endif
+
+		while (scratch_.size() < numThreads) {
+			scratch_.push_back(new LinearProgramScratch());
+		}
+
+		/*
+		 * Active agents are solved in groups of four, one agent per SIMD lane.
+		 * Dormant agents keep their position and zero velocity.
+		 */
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < static_cast<int>((activeAgents_.size() + 3) / 4); ++i) {
+#ifdef _OPENMP
+			LinearProgramScratch &scratch = *scratch_[omp_get_thread_num()];
+#else
+			LinearProgramScratch &scratch = *scratch_[0];
+#endif
+
+			const size_t beginAgent = 4 * static_cast<size_t>(i);
+			const size_t numAgents = std::min(activeAgents_.size() - beginAgent, static_cast<size_t>(4));
+
+			Agent *solvedAgents[4];
+			size_t numSolvedAgents = 0;
+
+			for (size_t j = beginAgent; j < beginAgent + numAgents; ++j) {
+				Agent *const agent = activeAgents_[j];
+
+				if (agent->freeFlightSteps_ > 0 && neighborSkin_ == 0.0f && !rebuildNeighborLists_) {
+					--agent->freeFlightSteps_;
+				}
+				else {
+					agent->computeNeighbors();
+				}
+
+				/* Agents without neighbors move at their clamped preferred velocity below. */
+				agentFreeFlight_[agent->id_] = (agent->agentNeighbors_.size() == 0 && agent->obstacleNeighbors_.size() == 0);
+
+				if (agentFreeFlight_[agent->id_]) {
+					agent->orcaLines_.clear();
+					agent->numObstLines_ = 0;
+				}
+				else {
+					agent->computeORCALines();
+					solvedAgents[numSolvedAgents++] = agent;
+				}
+			}
+
+			Agent::computeNewVelocities(solvedAgents, numSolvedAgents, scratch);
+		}
+
+		rebuildNeighborLists_ = false;
+
+		if (!lowDetailAgents_.empty()) {
+			if (lowDetailStep_ % lowDetailInterval_ == 0) {
+				Real maxRadius = 0.0f;
+
+				for (size_t i = 0; i < agents_.size(); ++i) {
+					maxRadius = std::max(maxRadius, agents_[i]->radius_);
+				}
+
+				lowDetailGrid_->build(agentPositions_, 4.0f * maxRadius);
 
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
-		for (int i = 0; i < static_cast<int>(agents_.size()); ++i) {
-			agents_[i]->computeNeighbors();
-			agents_[i]->computeNewVelocity();
+				for (int i = 0; i < static_cast<int>(lowDetailAgents_.size()); ++i) {
+					lowDetailAgents_[i]->computeSeparation(*lowDetailGrid_);
+					lowDetailAgents_[i]->computeLowDetailCandidates();
+				}
+			}
+
+			++lowDetailStep_;
+		}
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (int i = 0; i < static_cast<int>(activeAgents_.size()); ++i) {
+			const size_t agentNo = activeAgents_[i]->id_;
+
+			if (agentFreeFlight_[agentNo]) {
+				/* The result of linearProgram2 without any lines. */
+				const Real maxSpeed = activeAgents_[i]->maxSpeed_;
+				const Vector2 &prefVelocity = agentPrefVelocities_[agentNo];
+
+				agentNewVelocities_[agentNo] = (absSq(prefVelocity) > sqr(maxSpeed) ? normalize(prefVelocity) * maxSpeed : prefVelocity);
+			}
+
+			agentVelocities_[agentNo] = agentNewVelocities_[agentNo];
+			agentPositions_[agentNo] += agentVelocities_[agentNo] * timeStep_;
 		}
 
+		/* Low-detail agents steer along their preferred velocity, kept apart and out of obstacles. */
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
-		for (int i = 0; i < static_cast<int>(agents_.size()); ++i) {
-			agents_[i]->update();
+		for (int i = 0; i < static_cast<int>(lowDetailAgents_.size()); ++i) {
+#ifdef _OPENMP
+			LinearProgramScratch &scratch = *scratch_[omp_get_thread_num()];
+#else
+			LinearProgramScratch &scratch = *scratch_[0];
+#endif
+
+			const size_t agentNo = lowDetailAgents_[i]->id_;
+
+			lowDetailAgents_[i]->computeLowDetailVelocity(scratch);
+			agentVelocities_[agentNo] = agentNewVelocities_[agentNo];
+			agentPositions_[agentNo] += agentVelocities_[agentNo] * timeStep_;
 		}
 
 		globalTime_ += timeStep_;
@@ -216,12 +500,12 @@ namespace RVO {
 		return agents_[agentNo]->maxNeighbors_;
 	}
 
-	float RVOSimulator::getAgentMaxSpeed(size_t agentNo) const
+	Real RVOSimulator::getAgentMaxSpeed(size_t agentNo) const
 	{
 		return agents_[agentNo]->maxSpeed_;
 	}
 
-	float RVOSimulator::getAgentNeighborDist(size_t agentNo) const
+	Real RVOSimulator::getAgentNeighborDist(size_t agentNo) const
 	{
 		return agents_[agentNo]->neighborDist_;
 	}
@@ -241,6 +525,11 @@ namespace RVO {
 		return agents_[agentNo]->orcaLines_.size();
 	}
 
+	size_t RVOSimulator::getAgentNumObstacleORCALines(size_t agentNo) const
+	{
+		return agents_[agentNo]->numObstLines_;
+	}
+
 	size_t RVOSimulator::getAgentObstacleNeighbor(size_t agentNo, size_t neighborNo) const
 	{
 		return agents_[agentNo]->obstacleNeighbors_[neighborNo].second->id_;
@@ -253,37 +542,52 @@ namespace RVO {
 
 	const Vector2 &RVOSimulator::getAgentPosition(size_t agentNo) const
 	{
-		return agents_[agentNo]->position_;
+		return agentPositions_[agentNo];
 	}
 
 	const Vector2 &RVOSimulator::getAgentPrefVelocity(size_t agentNo) const
 	{
-		return agents_[agentNo]->prefVelocity_;
+		return agentPrefVelocities_[agentNo];
 	}
 
-	float RVOSimulator::getAgentRadius(size_t agentNo) const
+	Real RVOSimulator::getAgentRadius(size_t agentNo) const
 	{
 		return agents_[agentNo]->radius_;
 	}
 
-	float RVOSimulator::getAgentTimeHorizon(size_t agentNo) const
+	Real RVOSimulator::getAgentTimeHorizon(size_t agentNo) const
 	{
 		return agents_[agentNo]->timeHorizon_;
 	}
 
-	float RVOSimulator::getAgentTimeHorizonObst(size_t agentNo) const
+	Real RVOSimulator::getAgentTimeHorizonObst(size_t agentNo) const
 	{
 		return agents_[agentNo]->timeHorizonObst_;
 	}
 
 	const Vector2 &RVOSimulator::getAgentVelocity(size_t agentNo) const
 	{
-		return agents_[agentNo]->velocity_;
+		return agentVelocities_[agentNo];
 	}
 
-	float RVOSimulator::getGlobalTime() const
+	Real RVOSimulator::getDetailMargin() const
 	{
-		return globalTime_;
+		return detailMargin_;
+	}
+
+	Real RVOSimulator::getGlobalTime() const
+	{
+		return static_cast<Real>(globalTime_);
+	}
+
+	size_t RVOSimulator::getLowDetailInterval() const
+	{
+		return lowDetailInterval_;
+	}
+
+	Real RVOSimulator::getNeighborSkin() const
+	{
+		return neighborSkin_;
 	}
 
 	size_t RVOSimulator::getNumAgents() const
@@ -311,22 +615,65 @@ namespace RVO {
 		return obstacles_[vertexNo]->prevObstacle_->id_;
 	}
 
-	float RVOSimulator::getTimeStep() const
+	Real RVOSimulator::getTimeStep() const
 	{
 		return timeStep_;
 	}
 
+	bool RVOSimulator::isAgentDormant(size_t agentNo) const
+	{
+		return agents_[agentNo]->dormant_;
+	}
+
+	bool RVOSimulator::isAgentLowDetail(size_t agentNo) const
+	{
+		return agents_[agentNo]->lowDetail_;
+	}
+
+	bool RVOSimulator::isNearDetailRegion(const Vector2 &point) const
+	{
+		const Real marginSq = sqr(detailMargin_);
+
+		for (size_t i = 0; i < detailRegions_.size(); ++i) {
+			const std::vector<Vector2> &vertices = detailRegions_[i];
+			bool inside = false;
+
+			for (size_t j = 0, k = vertices.size() - 1; j < vertices.size(); k = j++) {
+				if (distSqPointLineSegment(vertices[k], vertices[j], point) < marginSq) {
+					return true;
+				}
+
+				/* Crossing test of a ray in the positive x-direction. */
+				if ((vertices[j].y() > point.y()) != (vertices[k].y() > point.y()) && point.x() < vertices[k].x() + (vertices[j].x() - vertices[k].x()) * (point.y() - vertices[k].y()) / (vertices[j].y() - vertices[k].y())) {
+					inside = !inside;
+				}
+			}
+
+			if (inside) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
 	void RVOSimulator::processObstacles()
 	{
 		kdTree_->buildObstacleTree();
+		rebuildNeighborLists_ = true;
 	}
 
-	bool RVOSimulator::queryVisibility(const Vector2 &point1, const Vector2 &point2, float radius) const
+	bool RVOSimulator::queryVisibility(const Vector2 &point1, const Vector2 &point2, Real radius) const
 	{
 		return kdTree_->queryVisibility(point1, point2, radius);
 	}
 
-	void RVOSimulator::setAgentDefaults(float neighborDist, size_t maxNeighbors, float timeHorizon, float timeHorizonObst, float radius, float maxSpeed, const Vector2 &velocity)
+	void RVOSimulator::queryVisibility(const std::vector<Vector2> &points1, const std::vector<Vector2> &points2, std::vector<bool> &visible, Real radius) const
+	{
+		kdTree_->queryVisibility(points1, points2, radius, visible);
+	}
+
+	void RVOSimulator::setAgentDefaults(Real neighborDist, size_t maxNeighbors, Real timeHorizon, Real timeHorizonObst, Real radius, Real maxSpeed, const Vector2 &velocity)
 	{
 		if (defaultAgent_ == NULL) {
 			defaultAgent_ = new Agent(this);
@@ -338,56 +685,145 @@ namespace RVO {
 		defaultAgent_->radius_ = radius;
 		defaultAgent_->timeHorizon_ = timeHorizon;
 		defaultAgent_->timeHorizonObst_ = timeHorizonObst;
-		defaultAgent_->velocity_ = velocity;
+		defaultVelocity_ = velocity;
+	}
+
+	void RVOSimulator::setAgentDormant(size_t agentNo, bool dormant)
+	{
+		Agent *const agent = agents_[agentNo];
+
+		if (agent->dormant_ == dormant) {
+			return;
+		}
+
+		agent->dormant_ = dormant;
+
+		if (dormant) {
+			agent->agentNeighbors_.reset(agent->maxNeighbors_);
+			agent->obstacleNeighbors_.reset();
+			agent->orcaLines_.clear();
+			agent->numObstLines_ = 0;
+			agentNewVelocities_[agentNo] = Vector2();
+			agentVelocities_[agentNo] = Vector2();
+		}
+
+		dormantAgentsChanged_ = true;
+		rebuildNeighborLists_ = true;
 	}
 
 	void RVOSimulator::setAgentMaxNeighbors(size_t agentNo, size_t maxNeighbors)
 	{
 		agents_[agentNo]->maxNeighbors_ = maxNeighbors;
+		rebuildNeighborLists_ = true;
 	}
 
-	void RVOSimulator::setAgentMaxSpeed(size_t agentNo, float maxSpeed)
+	void RVOSimulator::setAgentMaxSpeed(size_t agentNo, Real maxSpeed)
 	{
 		agents_[agentNo]->maxSpeed_ = maxSpeed;
+		rebuildNeighborLists_ = true;
 	}
 
-	void RVOSimulator::setAgentNeighborDist(size_t agentNo, float neighborDist)
+	void RVOSimulator::setAgentNeighborDist(size_t agentNo, Real neighborDist)
 	{
 		agents_[agentNo]->neighborDist_ = neighborDist;
+		maxNeighborDist_ = std::max(maxNeighborDist_, neighborDist);
+		rebuildNeighborLists_ = true;
 	}
 
 	void RVOSimulator::setAgentPosition(size_t agentNo, const Vector2 &position)
 	{
-		agents_[agentNo]->position_ = position;
+		agentPositions_[agentNo] = position;
+		rebuildNeighborLists_ = true;
+
+		if (agents_[agentNo]->dormant_) {
+			dormantAgentsChanged_ = true;
+		}
 	}
 
 	void RVOSimulator::setAgentPrefVelocity(size_t agentNo, const Vector2 &prefVelocity)
 	{
-		agents_[agentNo]->prefVelocity_ = prefVelocity;
+		agentPrefVelocities_[agentNo] = prefVelocity;
 	}
 
-	void RVOSimulator::setAgentRadius(size_t agentNo, float radius)
+	void RVOSimulator::setAgentRadius(size_t agentNo, Real radius)
 	{
 		agents_[agentNo]->radius_ = radius;
+		rebuildNeighborLists_ = true;
 	}
 
-	void RVOSimulator::setAgentTimeHorizon(size_t agentNo, float timeHorizon)
+	void RVOSimulator::setAgentTimeHorizon(size_t agentNo, Real timeHorizon)
 	{
 		agents_[agentNo]->timeHorizon_ = timeHorizon;
 	}
 
-	void RVOSimulator::setAgentTimeHorizonObst(size_t agentNo, float timeHorizonObst)
+	void RVOSimulator::setAgentTimeHorizonObst(size_t agentNo, Real timeHorizonObst)
 	{
 		agents_[agentNo]->timeHorizonObst_ = timeHorizonObst;
+		rebuildNeighborLists_ = true;
 	}
 	
 	void RVOSimulator::setAgentVelocity(size_t agentNo, const Vector2 &velocity)
 	{
-		agents_[agentNo]->velocity_ = velocity;
+		agentVelocities_[agentNo] = velocity;
 	}
 	
-	void RVOSimulator::setTimeStep(float timeStep)
+	void RVOSimulator::setDetailMargin(Real detailMargin)
+	{
+		detailMargin_ = detailMargin;
+	}
+
+	void RVOSimulator::setLowDetailInterval(size_t lowDetailInterval)
+	{
+		/* An interval of zero would never update the low-detail agents. */
+		lowDetailInterval_ = std::max(lowDetailInterval, static_cast<size_t>(1));
+	}
+
+	void RVOSimulator::setNeighborSkin(Real neighborSkin)
+	{
+		neighborSkin_ = neighborSkin;
+		rebuildNeighborLists_ = true;
+	}
+
+	void RVOSimulator::setTimeStep(Real timeStep)
 	{
 		timeStep_ = timeStep;
+		rebuildNeighborLists_ = true;
+	}
+	void RVOSimulator::updateLevelsOfDetail()
+	{
+		for (size_t i = 0; i < agents_.size(); ++i) {
+			Agent *const agent = agents_[i];
+
+			if (agent->dormant_) {
+				continue;
+			}
+
+			const bool lowDetail = !isNearDetailRegion(agentPositions_[i]);
+
+			if (lowDetail == agent->lowDetail_) {
+				continue;
+			}
+
+			agent->lowDetail_ = lowDetail;
+			lowDetailAgentsChanged_ = true;
+
+			if (lowDetail) {
+				agent->agentNeighbors_.reset(agent->maxNeighbors_);
+				agent->obstacleNeighbors_.reset();
+				agent->orcaLines_.clear();
+				agent->numObstLines_ = 0;
+
+				/* Demoted agents keep out of obstacles until the next update. */
+				agent->computeLowDetailCandidates();
+			}
+			else {
+				/* Promoted agents search their neighbors from scratch. */
+				agent->freeFlightSteps_ = 0;
+
+				if (neighborSkin_ > 0.0f) {
+					rebuildNeighborLists_ = true;
+				}
+			}
+		}
 	}
 }
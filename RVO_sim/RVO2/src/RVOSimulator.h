@@ -94,9 +94,14 @@ namespace RVO {
 	};
 
 	class Agent;
+	class AgentGrid;
 	class KdTree;
+	class LinearProgramScratch;
 	class Obstacle;
 
+	template <class T>
+	class Arena;
+
 	/**
 	 * \brief      Defines the simulation.
 	 *
@@ -150,9 +155,9 @@ namespace RVO {
 		 * \param      velocity        The default initial two-dimensional linear
 		 *                             velocity of a new agent (optional).
 		 */
-		RVOSimulator(float timeStep, float neighborDist, size_t maxNeighbors,
-					 float timeHorizon, float timeHorizonObst, float radius,
-					 float maxSpeed, const Vector2 &velocity = Vector2());
+		RVOSimulator(Real timeStep, Real neighborDist, size_t maxNeighbors,
+					 Real timeHorizon, Real timeHorizonObst, Real radius,
+					 Real maxSpeed, const Vector2 &velocity = Vector2());
 
 		/**
 		 * \brief      Destroys this simulator instance.
@@ -210,11 +215,26 @@ namespace RVO {
 		 *                             of this agent (optional).
 		 * \return     The number of the agent.
 		 */
-		size_t addAgent(const Vector2 &position, float neighborDist,
-						size_t maxNeighbors, float timeHorizon,
-						float timeHorizonObst, float radius, float maxSpeed,
+		size_t addAgent(const Vector2 &position, Real neighborDist,
+						size_t maxNeighbors, Real timeHorizon,
+						Real timeHorizonObst, Real radius, Real maxSpeed,
 						const Vector2 &velocity = Vector2());
 
+		/**
+		 * \brief      Adds a new region of interest to the simulation. Once
+		 *             regions have been added, only agents within the detail
+		 *             margin of some region are simulated with ORCA; the other
+		 *             agents steer along their preferred velocity, keep apart
+		 *             from nearby agents without avoiding them, and are kept
+		 *             out of obstacles. Agents change between the two models
+		 *             at the start of every low-detail interval.
+		 * \param      vertices        List of the vertices of the polygonal
+		 *                             region, in either order.
+		 * \return     The number of the region, or RVO::RVO_ERROR if it has
+		 *             fewer than three vertices.
+		 */
+		size_t addDetailRegion(const std::vector<Vector2> &vertices);
+
 		/**
 		 * \brief      Adds a new obstacle to the simulation.
 		 * \param      vertices        List of the vertices of the polygonal
@@ -259,7 +279,7 @@ namespace RVO {
 		 *                             is to be retrieved.
 		 * \return     The present maximum speed of the agent.
 		 */
-		float getAgentMaxSpeed(size_t agentNo) const;
+		Real getAgentMaxSpeed(size_t agentNo) const;
 
 		/**
 		 * \brief      Returns the maximum neighbor distance of a specified
@@ -268,7 +288,7 @@ namespace RVO {
 		 *                             neighbor distance is to be retrieved.
 		 * \return     The present maximum neighbor distance of the agent.
 		 */
-		float getAgentNeighborDist(size_t agentNo) const;
+		Real getAgentNeighborDist(size_t agentNo) const;
 
 		/**
 		 * \brief      Returns the count of agent neighbors taken into account to
@@ -301,6 +321,18 @@ namespace RVO {
 		 */
 		size_t getAgentNumORCALines(size_t agentNo) const;
 
+		/**
+		 * \brief      Returns the count of ORCA constraints due to obstacles
+		 *             used to compute the current velocity for the specified
+		 *             agent. These come first among its ORCA constraints.
+		 * \param      agentNo         The number of the agent whose count of
+		 *                             obstacle ORCA constraints is to be
+		 *                             retrieved.
+		 * \return     The count of obstacle ORCA constraints used to compute
+		 *             the current velocity for the specified agent.
+		 */
+		size_t getAgentNumObstacleORCALines(size_t agentNo) const;
+
 		/**
 		 * \brief      Returns the specified obstacle neighbor of the specified
 		 *             agent.
@@ -334,6 +366,7 @@ namespace RVO {
 		 *                             two-dimensional position is to be retrieved.
 		 * \return     The present two-dimensional position of the (center of the)
 		 *             agent.
+		 * \note       The reference is invalidated when an agent is added.
 		 */
 		const Vector2 &getAgentPosition(size_t agentNo) const;
 
@@ -344,6 +377,7 @@ namespace RVO {
 		 *                             two-dimensional preferred velocity is to be
 		 *                             retrieved.
 		 * \return     The present two-dimensional preferred velocity of the agent.
+		 * \note       The reference is invalidated when an agent is added.
 		 */
 		const Vector2 &getAgentPrefVelocity(size_t agentNo) const;
 
@@ -353,7 +387,7 @@ namespace RVO {
 		 *                             be retrieved.
 		 * \return     The present radius of the agent.
 		 */
-		float getAgentRadius(size_t agentNo) const;
+		Real getAgentRadius(size_t agentNo) const;
 
 		/**
 		 * \brief      Returns the time horizon of a specified agent.
@@ -361,7 +395,7 @@ namespace RVO {
 		 *                             is to be retrieved.
 		 * \return     The present time horizon of the agent.
 		 */
-		float getAgentTimeHorizon(size_t agentNo) const;
+		Real getAgentTimeHorizon(size_t agentNo) const;
 
 		/**
 		 * \brief      Returns the time horizon with respect to obstacles of a
@@ -372,7 +406,7 @@ namespace RVO {
 		 * \return     The present time horizon with respect to obstacles of the
 		 *             agent.
 		 */
-		float getAgentTimeHorizonObst(size_t agentNo) const;
+		Real getAgentTimeHorizonObst(size_t agentNo) const;
 
 		/**
 		 * \brief      Returns the two-dimensional linear velocity of a
@@ -381,14 +415,37 @@ namespace RVO {
 		 *                             two-dimensional linear velocity is to be
 		 *                             retrieved.
 		 * \return     The present two-dimensional linear velocity of the agent.
+		 * \note       The reference is invalidated when an agent is added.
 		 */
 		const Vector2 &getAgentVelocity(size_t agentNo) const;
 
+		/**
+		 * \brief      Returns the detail margin of the simulation.
+		 * \return     The present distance from the regions of interest within
+		 *             which agents are simulated with ORCA.
+		 */
+		Real getDetailMargin() const;
+
 		/**
 		 * \brief      Returns the global time of the simulation.
 		 * \return     The present global time of the simulation (zero initially).
 		 */
-		float getGlobalTime() const;
+		Real getGlobalTime() const;
+
+		/**
+		 * \brief      Returns the number of steps between the updates of the
+		 *             separation and obstacle candidates of the low-detail agents.
+		 * \return     The present update interval of the low-detail agents.
+		 */
+		size_t getLowDetailInterval() const;
+
+		/**
+		 * \brief      Returns the skin distance of the neighbor lists of the
+		 *             simulation.
+		 * \return     The present skin distance of the neighbor lists (zero if
+		 *             neighbors are searched on every step).
+		 */
+		Real getNeighborSkin() const;
 
 		/**
 		 * \brief      Returns the count of agents in the simulation.
@@ -436,7 +493,26 @@ namespace RVO {
 		 * \brief      Returns the time step of the simulation.
 		 * \return     The present time step of the simulation.
 		 */
-		float getTimeStep() const;
+		Real getTimeStep() const;
+
+		/**
+		 * \brief      Returns whether a specified agent is dormant.
+		 * \param      agentNo         The number of the agent whose state is to
+		 *                             be retrieved.
+		 * \return     True if the agent is dormant; false otherwise.
+		 */
+		bool isAgentDormant(size_t agentNo) const;
+
+		/**
+		 * \brief      Returns whether a specified agent is simulated with the
+		 *             low-detail model.
+		 * \param      agentNo         The number of the agent whose state is to
+		 *                             be retrieved.
+		 * \return     True if the agent was farther than the detail margin from
+		 *             all regions of interest at the start of the last step;
+		 *             false otherwise.
+		 */
+		bool isAgentLowDetail(size_t agentNo) const;
 
 		/**
 		 * \brief      Processes the obstacles that have been added so that they
@@ -460,7 +536,29 @@ namespace RVO {
 		 *             processed.
 		 */
 		bool queryVisibility(const Vector2 &point1, const Vector2 &point2,
-							 float radius = 0.0f) const;
+							 Real radius = 0.0f) const;
+
+		/**
+		 * \brief      Performs a batch of visibility queries with respect to the
+		 *             obstacles in a single traversal of the obstacle tree.
+		 *             Query i is between points1[i] and points2[i].
+		 * \param      points1         The first points of the queries.
+		 * \param      points2         The second points of the queries. Extra
+		 *                             points in the longer of the two lists are
+		 *                             ignored.
+		 * \param      visible         Receives for each query whether the two
+		 *                             points are mutually visible. All queries
+		 *                             are visible when the obstacles have not
+		 *                             been processed.
+		 * \param      radius          The minimal distance between the line
+		 *                             connecting two points and the obstacles
+		 *                             in order for the points to be mutually
+		 *                             visible (optional). Must be non-negative.
+		 */
+		void queryVisibility(const std::vector<Vector2> &points1,
+							 const std::vector<Vector2> &points2,
+							 std::vector<bool> &visible,
+							 Real radius = 0.0f) const;
 
 		/**
 		 * \brief      Sets the default properties for any new agent that is
@@ -501,11 +599,25 @@ namespace RVO {
 		 * \param      velocity        The default initial two-dimensional linear
 		 *                             velocity of a new agent (optional).
 		 */
-		void setAgentDefaults(float neighborDist, size_t maxNeighbors,
-							  float timeHorizon, float timeHorizonObst,
-							  float radius, float maxSpeed,
+		void setAgentDefaults(Real neighborDist, size_t maxNeighbors,
+							  Real timeHorizon, Real timeHorizonObst,
+							  Real radius, Real maxSpeed,
 							  const Vector2 &velocity = Vector2());
 
+		/**
+		 * \brief      Sets whether a specified agent is dormant. A dormant agent
+		 *             stands still and is skipped by the simulation steps, but
+		 *             the other agents still avoid it. Dormant agents are kept
+		 *             in a separate <i>k</i>d-tree that is only rebuilt when
+		 *             agents change their state.
+		 * \param      agentNo         The number of the agent whose state is to
+		 *                             be modified.
+		 * \param      dormant         True to make the agent dormant (its
+		 *                             velocity is set to zero); false to make it
+		 *                             active again.
+		 */
+		void setAgentDormant(size_t agentNo, bool dormant);
+
 		/**
 		 * \brief      Sets the maximum neighbor count of a specified agent.
 		 * \param      agentNo         The number of the agent whose maximum
@@ -521,7 +633,7 @@ namespace RVO {
 		 * \param      maxSpeed        The replacement maximum speed. Must be
 		 *                             non-negative.
 		 */
-		void setAgentMaxSpeed(size_t agentNo, float maxSpeed);
+		void setAgentMaxSpeed(size_t agentNo, Real maxSpeed);
 
 		/**
 		 * \brief      Sets the maximum neighbor distance of a specified agent.
@@ -530,7 +642,7 @@ namespace RVO {
 		 * \param      neighborDist    The replacement maximum neighbor distance.
 		 *                             Must be non-negative.
 		 */
-		void setAgentNeighborDist(size_t agentNo, float neighborDist);
+		void setAgentNeighborDist(size_t agentNo, Real neighborDist);
 
 		/**
 		 * \brief      Sets the two-dimensional position of a specified agent.
@@ -559,7 +671,7 @@ namespace RVO {
 		 * \param      radius          The replacement radius.
 		 *                             Must be non-negative.
 		 */
-		void setAgentRadius(size_t agentNo, float radius);
+		void setAgentRadius(size_t agentNo, Real radius);
 
 		/**
 		 * \brief      Sets the time horizon of a specified agent with respect
@@ -569,7 +681,7 @@ namespace RVO {
 		 * \param      timeHorizon     The replacement time horizon with respect
 		 *                             to other agents. Must be positive.
 		 */
-		void setAgentTimeHorizon(size_t agentNo, float timeHorizon);
+		void setAgentTimeHorizon(size_t agentNo, Real timeHorizon);
 
 		/**
 		 * \brief      Sets the time horizon of a specified agent with respect
@@ -579,7 +691,7 @@ namespace RVO {
 		 * \param      timeHorizonObst The replacement time horizon with respect to
 		 *                             obstacles. Must be positive.
 		 */
-		void setAgentTimeHorizonObst(size_t agentNo, float timeHorizonObst);
+		void setAgentTimeHorizonObst(size_t agentNo, Real timeHorizonObst);
 
 		/**
 		 * \brief      Sets the two-dimensional linear velocity of a specified
@@ -592,20 +704,104 @@ namespace RVO {
 		 */
 		void setAgentVelocity(size_t agentNo, const Vector2 &velocity);
 
+		/**
+		 * \brief      Sets the detail margin of the simulation. As agents
+		 *             change between the models only once every low-detail
+		 *             interval, the margin should cover the distance they move
+		 *             in that time.
+		 * \param      detailMargin    The distance from the regions of interest
+		 *                             within which agents are simulated with
+		 *                             ORCA. Must be non-negative; zero by
+		 *                             default.
+		 */
+		void setDetailMargin(Real detailMargin);
+
+		/**
+		 * \brief      Sets the number of steps between the updates of the
+		 *             separation and obstacle candidates of the low-detail
+		 *             agents. The low-detail agents move on every step, pushed
+		 *             by the separation of the last update and kept out of the
+		 *             obstacles among the candidates.
+		 * \param      lowDetailInterval The update interval of the low-detail
+		 *                             agents. Zero is taken as one; four by
+		 *                             default.
+		 */
+		void setLowDetailInterval(size_t lowDetailInterval);
+
+		/**
+		 * \brief      Sets the skin distance of the neighbor lists of the
+		 *             simulation. If positive, each agent caches the agents and
+		 *             obstacles within its ranges plus the skin and filters
+		 *             them on every step. The caches are rebuilt with a full
+		 *             search only after some agent has moved more than half the
+		 *             skin, or agents, obstacles or ranges have changed.
+		 * \param      neighborSkin    The skin distance of the neighbor lists.
+		 *                             Must be non-negative; zero (the default)
+		 *                             searches neighbors on every step.
+		 */
+		void setNeighborSkin(Real neighborSkin);
+
 		/**
 		 * \brief      Sets the time step of the simulation.
 		 * \param      timeStep        The time step of the simulation.
 		 *                             Must be positive.
 		 */
-		void setTimeStep(float timeStep);
+		void setTimeStep(Real timeStep);
 		
 	private:
+		/**
+		 * \brief      Adds a new agent to the neighbor lists, if they are in
+		 *             use and not about to be rebuilt. Otherwise ends the free
+		 *             flight of the agents the new agent may reach.
+		 * \param      agent           A pointer to the new agent.
+		 */
+		void addToNeighborLists(Agent *agent);
+
+		/**
+		 * \brief      Returns whether a point is within the detail margin of
+		 *             some region of interest.
+		 * \param      point           The point to be tested.
+		 * \return     True if the point is inside or near a region.
+		 */
+		bool isNearDetailRegion(const Vector2 &point) const;
+
+		/**
+		 * \brief      Moves the active agents between the ORCA and the
+		 *             low-detail model according to their distance from the
+		 *             regions of interest.
+		 */
+		void updateLevelsOfDetail();
+
+		std::vector<Agent *> activeAgents_;
+		Arena<Agent> *agentArena_;
 		std::vector<Agent *> agents_;
+		std::vector<char> agentFreeFlight_;
+		std::vector<Vector2> agentNewVelocities_;
+		std::vector<Vector2> agentPositions_;
+		std::vector<Vector2> agentPrefVelocities_;
+		std::vector<Vector2> agentVelocities_;
 		Agent *defaultAgent_;
-		float globalTime_;
+		Vector2 defaultVelocity_;
+		std::vector<std::vector<Vector2> > detailRegions_;
+		Real detailMargin_;
+		size_t detailStep_;
+		bool dormantAgentsChanged_;
+		double globalTime_;
 		KdTree *kdTree_;
+		std::vector<Agent *> lowDetailAgents_;
+		bool lowDetailAgentsChanged_;
+		AgentGrid *lowDetailGrid_;
+		size_t lowDetailInterval_;
+		size_t lowDetailStep_;
+		Real maxAgentSpeed_;
+		Real maxNeighborDist_;
+		std::vector<Vector2> neighborListPositions_;
+		Real neighborSkin_;
+		Arena<Obstacle> *obstacleArena_;
 		std::vector<Obstacle *> obstacles_;
-		float timeStep_;
+		bool rebuildNeighborLists_;
+		std::vector<LinearProgramScratch *> scratch_;
+		Real timeStep_;
 		
 		friend class Agent;
 		friend class KdTree;
@@ -66,6 +66,16 @@
 #include <ostream>
 
 namespace RVO {
+	/**
+	 * \brief      The scalar type of the library. Single precision unless
+	 *             RVO_DOUBLE_PRECISION is defined.
+	 */
+#ifdef RVO_DOUBLE_PRECISION
+	typedef double Real;
+#else
+	typedef float Real;
+#endif
+
 	/**
 	 * \brief      Defines a two-dimensional vector.
 	 */
@@ -85,19 +95,19 @@ namespace RVO {
 		 * \param      y               The y-coordinate of the two-dimensional
 		 *                             vector.
 		 */
-		inline Vector2(float x, float y) : x_(x), y_(y) { }
+		inline Vector2(Real x, Real y) : x_(x), y_(y) { }
 
 		/**
 		 * \brief      Returns the x-coordinate of this two-dimensional vector.
 		 * \return     The x-coordinate of the two-dimensional vector.
 		 */
-		inline float x() const { return x_; }
+		inline Real x() const { return x_; }
 
 		/**
 		 * \brief      Returns the y-coordinate of this two-dimensional vector.
 		 * \return     The y-coordinate of the two-dimensional vector.
 		 */
-		inline float y() const { return y_; }
+		inline Real y() const { return y_; }
 
 		/**
 		 * \brief      Computes the negation of this two-dimensional vector.
@@ -116,7 +126,7 @@ namespace RVO {
 		 * \return     The dot product of this two-dimensional vector with a
 		 *             specified two-dimensional vector.
 		 */
-		inline float operator*(const Vector2 &vector) const
+		inline Real operator*(const Vector2 &vector) const
 		{
 			return x_ * vector.x() + y_ * vector.y();
 		}
@@ -129,7 +139,7 @@ namespace RVO {
 		 * \return     The scalar multiplication of this two-dimensional vector
 		 *             with a specified scalar value.
 		 */
-		inline Vector2 operator*(float s) const
+		inline Vector2 operator*(Real s) const
 		{
 			return Vector2(x_ * s, y_ * s);
 		}
@@ -142,9 +152,9 @@ namespace RVO {
 		 * \return     The scalar division of this two-dimensional vector with a
 		 *             specified scalar value.
 		 */
-		inline Vector2 operator/(float s) const
+		inline Vector2 operator/(Real s) const
 		{
-			const float invS = 1.0f / s;
+			const Real invS = 1.0f / s;
 
 			return Vector2(x_ * invS, y_ * invS);
 		}
@@ -206,7 +216,7 @@ namespace RVO {
 		 *                             multiplication should be computed.
 		 * \return     A reference to this two-dimensional vector.
 		 */
-		inline Vector2 &operator*=(float s)
+		inline Vector2 &operator*=(Real s)
 		{
 			x_ *= s;
 			y_ *= s;
@@ -221,9 +231,9 @@ namespace RVO {
 		 *                             division should be computed.
 		 * \return     A reference to this two-dimensional vector.
 		 */
-		inline Vector2 &operator/=(float s)
+		inline Vector2 &operator/=(Real s)
 		{
-			const float invS = 1.0f / s;
+			const Real invS = 1.0f / s;
 			x_ *= invS;
 			y_ *= invS;
 
@@ -262,8 +272,8 @@ namespace RVO {
 		}
 
 	private:
-		float x_;
-		float y_;
+		Real x_;
+		Real y_;
 	};
 
 	/**
@@ -277,7 +287,7 @@ namespace RVO {
 	 * \return     The scalar multiplication of the two-dimensional vector with the
 	 *             scalar value.
 	 */
-	inline Vector2 operator*(float s, const Vector2 &vector)
+	inline Vector2 operator*(Real s, const Vector2 &vector)
 	{
 		return Vector2(s * vector.x(), s * vector.y());
 	}
@@ -306,7 +316,7 @@ namespace RVO {
 	 *                             computed.
 	 * \return     The length of the two-dimensional vector.
 	 */
-	inline float abs(const Vector2 &vector)
+	inline Real abs(const Vector2 &vector)
 	{
 		return std::sqrt(vector * vector);
 	}
@@ -319,7 +329,7 @@ namespace RVO {
 	 *                             is to be computed.
 	 * \return     The squared length of the two-dimensional vector.
 	 */
-	inline float absSq(const Vector2 &vector)
+	inline Real absSq(const Vector2 &vector)
 	{
 		return vector * vector;
 	}
@@ -334,7 +344,7 @@ namespace RVO {
 	 *                             matrix.
 	 * \return     The determinant of the two-dimensional square matrix.
 	 */
-	inline float det(const Vector2 &vector1, const Vector2 &vector2)
+	inline Real det(const Vector2 &vector1, const Vector2 &vector2)
 	{
 		return vector1.x() * vector2.y() - vector1.y() * vector2.x();
 	}
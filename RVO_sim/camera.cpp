@@ -0,0 +1,341 @@
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE__) && !defined(RVO_DOUBLE_PRECISION)
+#include <xmmintrin.h>
+#define CAMERA_USE_SSE 1
+#endif
+
+#include "camera.hpp"
+
+// Half-width of the wedges cast around each obstacle vertex (in radians)
+static const float CAMERA_RAY_EPSILON = 1e-4f;
+
+// Distance from a wedge boundary within which points are tested directly
+static const float CAMERA_BOUNDARY_TOLERANCE = 1e-3f;
+
+// Largest number of grid cells per camera in the field of view index
+static const size_t CAMERA_GRID_CELLS_PER_CAMERA = 64;
+
+
+/* Function to cast a ray from a camera to the first obstacle edge it hits
+ *  Input(s):
+ *      RVOSimulator* sim     - simulator with processed obstacles
+ *      vector<size_t> edges  - obstacle vertices starting the edges that can
+ *                              block the camera
+ *      RVO::Vector2 center   - camera center
+ *      float angle           - direction of the ray
+ *      float maxDist         - length of the ray if it hits nothing
+ *  Output(s):
+ *      RVO::Vector2& hit     - end point of the ray
+ *      int&                  - vertex starting the edge hit, or -1
+ */
+static void castRay(RVO::RVOSimulator* sim,
+                    const vector<size_t>& edges,
+                    RVO::Vector2 center,
+                    float angle,
+                    float maxDist,
+                    RVO::Vector2& hit,
+                    int& edge)
+{
+    RVO::Vector2 d = RVO::Vector2(cos(angle), sin(angle));
+    float minDist = maxDist;
+    edge = -1;
+    for (size_t i = 0; i < edges.size(); i++) {
+        RVO::Vector2 a = sim->getObstacleVertex(edges[i]);
+        RVO::Vector2 b = sim->getObstacleVertex(sim->getNextObstacleVertexNo(edges[i]));
+        float denom = RVO::det(d, b - a);
+        if (denom == 0.0f) {
+            continue;
+        }
+        // Solve center + t*d = a + s*(b - a)
+        float t = RVO::det(a - center, b - a) / denom;
+        float s = RVO::det(a - center, d) / denom;
+        if (t > 0.0f && t < minDist && s >= 0.0f && s <= 1.0f) {
+            minDist = t;
+            edge = (int) edges[i];
+        }
+    }
+    hit = center + minDist * d;
+}
+
+
+void computeCameraVisibility(RVO::RVOSimulator* sim,
+                             RVO::Vector2 center,
+                             float range,
+                             CameraVisibility& visibility)
+{
+    // Rays that hit nothing end beyond the range, so that the chord between
+    // two of them (at most 30 degrees apart) still covers the range
+    float maxDist = 2.0f * range;
+
+    // Obstacles are one-sided: only edges with the camera on their outer
+    // (right) side block its view. Edges entirely outside the box the rays
+    // stay in are skipped, so that each ray is tested against nearby edges only
+    vector<size_t> edges;
+    vector<float> angles;
+    for (size_t i = 0; i < sim->getNumObstacleVertices(); i++) {
+        RVO::Vector2 a = sim->getObstacleVertex(i);
+        RVO::Vector2 b = sim->getObstacleVertex(sim->getNextObstacleVertexNo(i));
+        if (RVO::det(b - a, center - a) < 0.0f &&
+            max(a.x(), b.x()) > center.x() - maxDist && min(a.x(), b.x()) < center.x() + maxDist &&
+            max(a.y(), b.y()) > center.y() - maxDist && min(a.y(), b.y()) < center.y() + maxDist) {
+            edges.push_back(i);
+        }
+        // The visible region can only change direction at obstacle vertices
+        RVO::Vector2 offset = a - center;
+        if (absSq(offset) > 0.0f && absSq(offset) < maxDist * maxDist) {
+            float angle = atan2(offset.y(), offset.x());
+            angles.push_back(angle - CAMERA_RAY_EPSILON);
+            angles.push_back(angle);
+            angles.push_back(angle + CAMERA_RAY_EPSILON);
+        }
+    }
+    for (int i = 0; i < 12; i++) {
+        angles.push_back(-M_PI + i * M_PI / 6.0f);
+    }
+
+    // Keep the rays within [-pi, pi) so that atan2 always finds a wedge
+    for (size_t i = 0; i < angles.size(); i++) {
+        if (angles[i] < -M_PI) {
+            angles[i] += 2.0f * M_PI;
+        } else if (angles[i] >= M_PI) {
+            angles[i] -= 2.0f * M_PI;
+        }
+    }
+    sort(angles.begin(), angles.end());
+    angles.push_back(angles[0] + 2.0f * M_PI);
+
+    // Cast the rays
+    visibility.center = center;
+    visibility.angles = angles;
+    visibility.hits.resize(angles.size());
+    visibility.edges.resize(angles.size());
+    for (size_t i = 0; i < angles.size(); i++) {
+        castRay(sim, edges, center, angles[i], maxDist,
+                visibility.hits[i], visibility.edges[i]);
+    }
+}
+
+
+bool isVisibleFromCamera(RVO::RVOSimulator* sim,
+                         const CameraVisibility& visibility,
+                         RVO::Vector2 p)
+{
+    // Find the wedge containing p
+    RVO::Vector2 offset = p - visibility.center;
+    float angle = atan2(offset.y(), offset.x());
+    if (angle < visibility.angles[0]) {
+        angle += 2.0f * M_PI;
+    }
+    size_t k = upper_bound(visibility.angles.begin(), visibility.angles.end(), angle) -
+               visibility.angles.begin();
+    if (k == 0 || k == visibility.angles.size()) {
+        return sim->queryVisibility(visibility.center, p);
+    }
+    k--;
+
+    // Wedges around a vertex or bounded by different edges are not exact
+    if (visibility.edges[k] != visibility.edges[k+1] ||
+        visibility.angles[k+1] - visibility.angles[k] <= 2.0f * CAMERA_RAY_EPSILON) {
+        return sim->queryVisibility(visibility.center, p);
+    }
+
+    // p is visible if it is on the camera's (left) side of the wedge's chord
+    RVO::Vector2 h0 = visibility.hits[k];
+    RVO::Vector2 h1 = visibility.hits[k+1];
+    float side = RVO::det(h1 - h0, p - h0);
+    float tolerance = CAMERA_BOUNDARY_TOLERANCE * abs(h1 - h0);
+    if (side > tolerance) {
+        return true;
+    } else if (side < -tolerance) {
+        return false;
+    }
+    return sim->queryVisibility(visibility.center, p);
+}
+
+
+int compileCameraFOVs(const vector< vector<RVO::Vector2> >& polygons,
+                      CameraFOVs& fovs)
+{
+    fovs.numCameras = polygons.size();
+    fovs.numEdges = 0;
+    for (size_t i = 0; i < polygons.size(); i++) {
+        fovs.numEdges = max(fovs.numEdges, polygons[i].size());
+    }
+
+    // Bounding box of each field of view and of all of them
+    vector<RVO::Vector2> boxMin(polygons.size());
+    vector<RVO::Vector2> boxMax(polygons.size());
+    RVO::Vector2 sceneMin, sceneMax;
+    RVO::Real sumSize = 0.0f;
+    for (size_t i = 0; i < polygons.size(); i++) {
+        RVO::Real minX = polygons[i][0].x(), maxX = minX;
+        RVO::Real minY = polygons[i][0].y(), maxY = minY;
+        for (size_t j = 1; j < polygons[i].size(); j++) {
+            minX = min(minX, polygons[i][j].x());
+            maxX = max(maxX, polygons[i][j].x());
+            minY = min(minY, polygons[i][j].y());
+            maxY = max(maxY, polygons[i][j].y());
+        }
+        boxMin[i] = RVO::Vector2(minX, minY);
+        boxMax[i] = RVO::Vector2(maxX, maxY);
+        sumSize += max(maxX - minX, maxY - minY);
+        if (i == 0) {
+            sceneMin = boxMin[i];
+            sceneMax = boxMax[i];
+        } else {
+            sceneMin = RVO::Vector2(min(sceneMin.x(), minX), min(sceneMin.y(), minY));
+            sceneMax = RVO::Vector2(max(sceneMax.x(), maxX), max(sceneMax.y(), maxY));
+        }
+    }
+
+    // Cells about the size of a field of view, so that each overlaps a few
+    // cells, with at most CAMERA_GRID_CELLS_PER_CAMERA cells per camera
+    fovs.origin = sceneMin;
+    fovs.cellSize = (polygons.empty() || sumSize <= 0.0f) ? 1.0f : sumSize / polygons.size();
+    RVO::Real sceneWidth = sceneMax.x() - sceneMin.x();
+    RVO::Real sceneHeight = sceneMax.y() - sceneMin.y();
+    const RVO::Real maxCells = CAMERA_GRID_CELLS_PER_CAMERA * max((size_t) 1, polygons.size());
+    if ((sceneWidth / fovs.cellSize + 1.0f) * (sceneHeight / fovs.cellSize + 1.0f) > maxCells) {
+        fovs.cellSize = max(sceneWidth, sceneHeight) / (sqrt(maxCells) - 1.0f);
+    }
+    fovs.width = (size_t) (sceneWidth / fovs.cellSize) + 1;
+    fovs.height = (size_t) (sceneHeight / fovs.cellSize) + 1;
+
+    // List the cameras whose box overlaps each cell
+    vector< vector<int> > cellCameras(fovs.width * fovs.height);
+    for (size_t i = 0; i < polygons.size(); i++) {
+        size_t x0 = (size_t) ((boxMin[i].x() - fovs.origin.x()) / fovs.cellSize);
+        size_t y0 = (size_t) ((boxMin[i].y() - fovs.origin.y()) / fovs.cellSize);
+        size_t x1 = min(fovs.width - 1, (size_t) ((boxMax[i].x() - fovs.origin.x()) / fovs.cellSize));
+        size_t y1 = min(fovs.height - 1, (size_t) ((boxMax[i].y() - fovs.origin.y()) / fovs.cellSize));
+        for (size_t y = y0; y <= y1; y++) {
+            for (size_t x = x0; x <= x1; x++) {
+                cellCameras[y*fovs.width + x].push_back((int) i);
+            }
+        }
+    }
+
+    // Pack the cameras of each cell into groups
+    fovs.cellGroups.assign(cellCameras.size() + 1, 0);
+    fovs.groupCameras.clear();
+    for (size_t c = 0; c < cellCameras.size(); c++) {
+        fovs.cellGroups[c] = fovs.groupCameras.size() / CAMERA_GROUP_SIZE;
+        for (size_t k = 0; k < cellCameras[c].size(); k++) {
+            fovs.groupCameras.push_back(cellCameras[c][k]);
+        }
+        while (fovs.groupCameras.size() % CAMERA_GROUP_SIZE != 0) {
+            fovs.groupCameras.push_back(-1);
+        }
+    }
+    fovs.cellGroups[cellCameras.size()] = fovs.groupCameras.size() / CAMERA_GROUP_SIZE;
+
+    // Padding edges have a zero normal, so every point passes them
+    size_t tableSize = fovs.groupCameras.size() * fovs.numEdges;
+    fovs.nx.assign(tableSize, 0.0f);
+    fovs.ny.assign(tableSize, 0.0f);
+    fovs.px.assign(tableSize, 0.0f);
+    fovs.py.assign(tableSize, 0.0f);
+
+    for (size_t lane = 0; lane < fovs.groupCameras.size(); lane++) {
+        if (fovs.groupCameras[lane] < 0) {
+            continue;
+        }
+        size_t i = fovs.groupCameras[lane];
+        const vector<RVO::Vector2>& polygon = polygons[i];
+
+        // Orient the normals inward, whichever way the vertices are listed
+        RVO::Real area = 0.0f;
+        for (size_t j = 0; j < polygon.size(); j++) {
+            area += RVO::det(polygon[j], polygon[(j+1) % polygon.size()]);
+        }
+        RVO::Real orientation = (area < 0.0f) ? -1.0f : 1.0f;
+
+        for (size_t j = 0; j < polygon.size(); j++) {
+            RVO::Vector2 A = polygon[j];
+            RVO::Vector2 B = polygon[(j+1) % polygon.size()];
+            RVO::Vector2 C = polygon[(j+2) % polygon.size()];
+            if (orientation * RVO::det(B - A, C - B) < 0.0f) {
+                cout << "ERROR - Field of view of camera " << i << " is not convex" << endl;
+                return 1;
+            }
+            size_t index = ((lane / CAMERA_GROUP_SIZE) * fovs.numEdges + j) * CAMERA_GROUP_SIZE +
+                           lane % CAMERA_GROUP_SIZE;
+            fovs.nx[index] = -orientation * (B.y() - A.y());
+            fovs.ny[index] = orientation * (B.x() - A.x());
+            fovs.px[index] = A.x();
+            fovs.py[index] = A.y();
+        }
+    }
+
+    // Return
+    return 0;
+}
+
+
+void getCamerasContaining(const CameraFOVs& fovs,
+                          const RVO::Real* coords,
+                          size_t stride,
+                          size_t numPoints,
+                          vector<size_t>& pointCameras,
+                          vector<size_t>& cameras)
+{
+    pointCameras.resize(numPoints + 1);
+    cameras.clear();
+
+    for (size_t i = 0; i < numPoints; i++) {
+        RVO::Real x = coords[i*stride];
+        RVO::Real y = coords[i*stride + 1];
+        pointCameras[i] = cameras.size();
+
+        // Find the cell of the point
+        RVO::Real cellX = floor((x - fovs.origin.x()) / fovs.cellSize);
+        RVO::Real cellY = floor((y - fovs.origin.y()) / fovs.cellSize);
+        if (!(cellX >= 0.0f && cellX < fovs.width && cellY >= 0.0f && cellY < fovs.height)) {
+            continue;
+        }
+        size_t cell = (size_t) cellY * fovs.width + (size_t) cellX;
+
+        for (size_t g = fovs.cellGroups[cell]; g < fovs.cellGroups[cell+1]; g++) {
+            const size_t base = g * fovs.numEdges * CAMERA_GROUP_SIZE;
+            unsigned int inside;
+#ifdef CAMERA_USE_SSE
+            // Test the point against one edge of 4 cameras at a time
+            const __m128 vx = _mm_set1_ps(x);
+            const __m128 vy = _mm_set1_ps(y);
+            __m128 all = _mm_cmpeq_ps(vx, vx);
+            for (size_t j = 0; j < fovs.numEdges; j++) {
+                const size_t index = base + j * CAMERA_GROUP_SIZE;
+                __m128 dx = _mm_sub_ps(vx, _mm_loadu_ps(&fovs.px[index]));
+                __m128 dy = _mm_sub_ps(vy, _mm_loadu_ps(&fovs.py[index]));
+                __m128 side = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&fovs.nx[index]), dx),
+                                         _mm_mul_ps(_mm_loadu_ps(&fovs.ny[index]), dy));
+                all = _mm_and_ps(all, _mm_cmpge_ps(side, _mm_setzero_ps()));
+            }
+            inside = _mm_movemask_ps(all);
+#else
+            inside = (1u << CAMERA_GROUP_SIZE) - 1;
+            for (size_t j = 0; j < fovs.numEdges; j++) {
+                const size_t index = base + j * CAMERA_GROUP_SIZE;
+                for (size_t k = 0; k < CAMERA_GROUP_SIZE; k++) {
+                    RVO::Real side = fovs.nx[index+k] * (x - fovs.px[index+k]) +
+                                     fovs.ny[index+k] * (y - fovs.py[index+k]);
+                    if (side < 0.0f) {
+                        inside &= ~(1u << k);
+                    }
+                }
+            }
+#endif
+            // Skip the padding lanes
+            for (size_t k = 0; k < CAMERA_GROUP_SIZE; k++) {
+                int camera = fovs.groupCameras[g*CAMERA_GROUP_SIZE + k];
+                if ((inside & (1u << k)) && camera >= 0) {
+                    cameras.push_back(camera);
+                }
+            }
+        }
+    }
+    pointCameras[numPoints] = cameras.size();
+}
@@ -0,0 +1,128 @@
+#ifndef __CAMERA_H_INCLUDED__
+#define __CAMERA_H_INCLUDED__
+
+#include <vector>
+#include <stdint.h>
+#include "RVO.h"
+
+using namespace std;
+
+/* Region of the scene a camera has line of sight to
+ *  The region is star-shaped around the camera center and stored as rays in
+ *  increasing angle, each ending where it first hits an obstacle. Consecutive
+ *  rays bound a wedge; a wedge is exact when both of its rays hit the same
+ *  obstacle edge (or none), otherwise points in it are tested against the
+ *  obstacles directly.
+ *      RVO::Vector2 center     - camera center
+ *      vector<float> angles    - ray angles in [-pi, pi), plus a closing ray
+ *                                at the first angle + 2 pi
+ *      vector<RVO::Vector2> hits - end point of each ray
+ *      vector<int> edges       - obstacle vertex starting the edge each ray
+ *                                hits, or -1 if it hits none
+ */
+struct CameraVisibility {
+    RVO::Vector2 center;
+    vector<float> angles;
+    vector<RVO::Vector2> hits;
+    vector<int> edges;
+};
+
+
+/* Function to precompute the region visible from a camera
+ *  Input(s):
+ *      RVOSimulator* sim     - simulator with processed obstacles
+ *      RVO::Vector2 center   - camera center
+ *      float range           - farthest distance that must be covered
+ *  Output(s):
+ *      CameraVisibility& visibility - visible region of the camera
+ */
+void computeCameraVisibility(RVO::RVOSimulator* sim,
+                             RVO::Vector2 center,
+                             float range,
+                             CameraVisibility& visibility);
+
+
+/* Function to determine whether a point within range of a camera is in its
+ * line of sight, with the same one-sided obstacles as RVOSimulator::queryVisibility
+ *  Input(s):
+ *      RVOSimulator* sim     - simulator with processed obstacles
+ *      CameraVisibility& visibility - visible region of the camera
+ *      RVO::Vector2 p        - point
+ *  Output(s):
+ *      bool                  - true if no obstacle blocks the camera's view of p
+ */
+bool isVisibleFromCamera(RVO::RVOSimulator* sim,
+                         const CameraVisibility& visibility,
+                         RVO::Vector2 p);
+
+
+/* Fields of view of all cameras compiled into half-plane tests over a grid
+ *  A uniform grid covers the bounding boxes of the fields of view, and each
+ *  cell lists the cameras whose box overlaps it, packed in groups of
+ *  CAMERA_GROUP_SIZE. For each group and each edge of the polygons, the tables
+ *  hold one lane per camera of the inward normal (nx, ny) and start point
+ *  (px, py) of that camera's edge, so that a point p is inside the camera when
+ *  nx*(p.x-px) + ny*(p.y-py) >= 0 for all edges. Polygons with fewer edges are
+ *  padded with edges that every point passes.
+ *      size_t numCameras       - number of cameras
+ *      size_t numEdges         - edges per camera after padding
+ *      RVO::Vector2 origin     - lower left corner of the grid
+ *      RVO::Real cellSize      - side length of a cell
+ *      size_t width, height    - number of cells in x and y
+ *      vector<size_t> cellGroups - first group of each row-major cell, plus the
+ *                                total number of groups
+ *      vector<int> groupCameras  - camera in each lane of each group, or -1
+ *      vector<RVO::Real> nx, ny, px, py - tables indexed by
+ *                                ((group*numEdges + edge)*CAMERA_GROUP_SIZE + lane)
+ */
+static const size_t CAMERA_GROUP_SIZE = 4;
+
+struct CameraFOVs {
+    size_t numCameras;
+    size_t numEdges;
+    RVO::Vector2 origin;
+    RVO::Real cellSize;
+    size_t width;
+    size_t height;
+    vector<size_t> cellGroups;
+    vector<int> groupCameras;
+    vector<RVO::Real> nx;
+    vector<RVO::Real> ny;
+    vector<RVO::Real> px;
+    vector<RVO::Real> py;
+};
+
+
+/* Function to compile the field of view polygons of the cameras
+ *  Input(s):
+ *      vector<vector<RVO::Vector2>> polygons - convex polygon of each camera in
+ *                                              world coords, in either order
+ *  Output(s):
+ *      CameraFOVs& fovs      - compiled fields of view
+ *      int                   - 0 if successful, 1 if a polygon is not convex
+ */
+int compileCameraFOVs(const vector< vector<RVO::Vector2> >& polygons,
+                      CameraFOVs& fovs);
+
+
+/* Function to find the cameras whose field of view contains each of a batch
+ * of points, testing only the cameras near each point
+ *  Input(s):
+ *      CameraFOVs& fovs      - compiled fields of view
+ *      RVO::Real* coords     - x and y of the first point
+ *      size_t stride         - distance between the x of consecutive points
+ *      size_t numPoints      - number of points
+ *  Output(s):
+ *      vector<size_t>& pointCameras - index into cameras of the first camera
+ *                                     of each point, plus the total number
+ *      vector<size_t>& cameras      - cameras containing each point, in
+ *                                     increasing order
+ */
+void getCamerasContaining(const CameraFOVs& fovs,
+                          const RVO::Real* coords,
+                          size_t stride,
+                          size_t numPoints,
+                          vector<size_t>& pointCameras,
+                          vector<size_t>& cameras);
+
+#endif  // __CAMERA_H_INCLUDED__
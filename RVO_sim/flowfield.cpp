@@ -0,0 +1,400 @@
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <queue>
+#include <functional>
+#include <utility>
+
+#include "flowfield.hpp"
+
+// Cache file header
+static const char FLOW_FIELD_MAGIC[8] = {'R','V','O','F','L','O','W','\0'};
+static const uint32_t FLOW_FIELD_VERSION = 1;
+
+
+float distSqPointSegment(RVO::Vector2 a,
+                         RVO::Vector2 b,
+                         RVO::Vector2 p)
+{
+    float lengthSq = absSq(b - a);
+    if (lengthSq == 0.0f) {
+        return absSq(p - a);
+    }
+
+    // Project p onto the segment
+    float r = ((p - a) * (b - a)) / lengthSq;
+    if (r < 0.0f) {
+        return absSq(p - a);
+    } else if (r > 1.0f) {
+        return absSq(p - b);
+    } else {
+        return absSq(p - (a + r * (b - a)));
+    }
+}
+
+
+/* Function to collect the obstacles of the simulator as closed polygons
+ *  Input(s):
+ *      RVOSimulator* sim - simulator with processed obstacles
+ *  Output(s):
+ *      vector<vector<RVO::Vector2>> polygons - vertices of each obstacle
+ */
+static void getObstaclePolygons(RVO::RVOSimulator* sim,
+                                vector< vector<RVO::Vector2> >& polygons)
+{
+    vector<bool> visited(sim->getNumObstacleVertices(), false);
+    for (size_t i = 0; i < sim->getNumObstacleVertices(); i++) {
+        if (visited[i]) {
+            continue;
+        }
+        // Walk the loop of vertices this vertex belongs to
+        vector<RVO::Vector2> polygon;
+        size_t j = i;
+        do {
+            visited[j] = true;
+            polygon.push_back(sim->getObstacleVertex(j));
+            j = sim->getNextObstacleVertexNo(j);
+        } while (j != i && !visited[j]);
+        polygons.push_back(polygon);
+    }
+}
+
+
+/* Function to determine whether the center of a cell is blocked
+ *  Input(s):
+ *      vector<vector<RVO::Vector2>> polygons - obstacle polygons
+ *      vector<float> areas   - signed area of each polygon (negative for
+ *                              clockwise boundaries that enclose free space)
+ *      RVO::Vector2 p        - cell center
+ *      float clearance       - distance the center must keep from obstacles
+ *  Output(s):
+ *      bool                  - true if the cell is blocked
+ */
+static bool isBlocked(const vector< vector<RVO::Vector2> >& polygons,
+                      const vector<float>& areas,
+                      RVO::Vector2 p,
+                      float clearance)
+{
+    for (size_t i = 0; i < polygons.size(); i++) {
+        const vector<RVO::Vector2>& polygon = polygons[i];
+        bool inside = false;
+        for (size_t j = 0, k = polygon.size() - 1; j < polygon.size(); k = j++) {
+            if (distSqPointSegment(polygon[k], polygon[j], p) < clearance * clearance) {
+                return true;
+            }
+            // Crossing test of a ray in the positive x-direction
+            if ((polygon[j].y() > p.y()) != (polygon[k].y() > p.y()) &&
+                p.x() < polygon[k].x() + (polygon[j].x() - polygon[k].x()) * (p.y() - polygon[k].y()) / (polygon[j].y() - polygon[k].y())) {
+                inside = !inside;
+            }
+        }
+        // Counterclockwise obstacles are solid, clockwise ones enclose the scene
+        if (polygon.size() > 2 && ((areas[i] > 0.0f && inside) || (areas[i] < 0.0f && !inside))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/* Function to compute the descent directions of the distance fields
+ *  Input(s):
+ *      FlowFields& fields - fields with distances
+ *  Output(s):
+ *      FlowFields& fields - fields with directions
+ */
+static void computeFlowDirections(FlowFields& fields)
+{
+    fields.directions.assign(fields.distances.size(),
+                             vector<RVO::Vector2>(fields.width * fields.height));
+    for (size_t e = 0; e < fields.distances.size(); e++) {
+        const vector<float>& distance = fields.distances[e];
+        for (size_t y = 0; y < fields.height; y++) {
+            for (size_t x = 0; x < fields.width; x++) {
+                float d = distance[y * fields.width + x];
+                if (d < 0.0f) {
+                    continue;
+                }
+                // Sum the downhill slopes toward all reachable neighbors
+                RVO::Vector2 descent;
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        if ((dx == 0 && dy == 0) ||
+                            (x == 0 && dx < 0) || (x + 1 == fields.width && dx > 0) ||
+                            (y == 0 && dy < 0) || (y + 1 == fields.height && dy > 0)) {
+                            continue;
+                        }
+                        float n = distance[(y + dy) * fields.width + (x + dx)];
+                        if (n >= 0.0f && n < d) {
+                            RVO::Vector2 offset = RVO::Vector2((float) dx, (float) dy);
+                            descent += ((d - n) / absSq(offset)) * offset;
+                        }
+                    }
+                }
+                if (absSq(descent) > 0.0f) {
+                    fields.directions[e][y * fields.width + x] = normalize(descent);
+                }
+            }
+        }
+    }
+}
+
+
+uint64_t getFlowFieldKey(RVO::RVOSimulator* sim,
+                         const vector< vector<RVO::Vector2> >& exits,
+                         float cellSize,
+                         float clearance)
+{
+    // Hash the inputs as single precision floats
+    vector<float> values;
+    values.push_back(cellSize);
+    values.push_back(clearance);
+    for (size_t i = 0; i < sim->getNumObstacleVertices(); i++) {
+        values.push_back(sim->getObstacleVertex(i).x());
+        values.push_back(sim->getObstacleVertex(i).y());
+        values.push_back((float) sim->getNextObstacleVertexNo(i));
+    }
+    for (size_t i = 0; i < exits.size(); i++) {
+        for (size_t j = 0; j < exits[i].size(); j++) {
+            values.push_back(exits[i][j].x());
+            values.push_back(exits[i][j].y());
+        }
+    }
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    const unsigned char* bytes = (const unsigned char*) &values[0];
+    for (size_t i = 0; i < values.size() * sizeof(float); i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+
+int computeFlowFields(RVO::RVOSimulator* sim,
+                      const vector< vector<RVO::Vector2> >& exits,
+                      float cellSize,
+                      float clearance,
+                      FlowFields& fields)
+{
+    if (cellSize <= 0.0f || exits.empty()) {
+        cout << "ERROR - Flow fields need a positive cell size and at least one exit" << endl;
+        return 1;
+    }
+
+    // Collect obstacles and their orientation
+    vector< vector<RVO::Vector2> > polygons;
+    getObstaclePolygons(sim, polygons);
+    vector<float> areas;
+    for (size_t i = 0; i < polygons.size(); i++) {
+        float area = 0.0f;
+        for (size_t j = 0, k = polygons[i].size() - 1; j < polygons[i].size(); k = j++) {
+            area += RVO::det(polygons[i][k], polygons[i][j]);
+        }
+        areas.push_back(0.5f * area);
+    }
+
+    // Grid over the bounding box of obstacles and exits
+    RVO::Vector2 minPoint = exits[0][0];
+    RVO::Vector2 maxPoint = exits[0][0];
+    for (size_t i = 0; i < polygons.size(); i++) {
+        for (size_t j = 0; j < polygons[i].size(); j++) {
+            minPoint = RVO::Vector2(min(minPoint.x(), polygons[i][j].x()), min(minPoint.y(), polygons[i][j].y()));
+            maxPoint = RVO::Vector2(max(maxPoint.x(), polygons[i][j].x()), max(maxPoint.y(), polygons[i][j].y()));
+        }
+    }
+    for (size_t i = 0; i < exits.size(); i++) {
+        for (size_t j = 0; j < exits[i].size(); j++) {
+            minPoint = RVO::Vector2(min(minPoint.x(), exits[i][j].x()), min(minPoint.y(), exits[i][j].y()));
+            maxPoint = RVO::Vector2(max(maxPoint.x(), exits[i][j].x()), max(maxPoint.y(), exits[i][j].y()));
+        }
+    }
+    fields.cellSize = cellSize;
+    fields.origin = minPoint - RVO::Vector2(cellSize, cellSize);
+    fields.width = (size_t) ((maxPoint.x() - minPoint.x()) / cellSize) + 3;
+    fields.height = (size_t) ((maxPoint.y() - minPoint.y()) / cellSize) + 3;
+    size_t numCells = fields.width * fields.height;
+
+    // Mark blocked cells
+    vector<bool> blocked(numCells);
+    for (size_t y = 0; y < fields.height; y++) {
+        for (size_t x = 0; x < fields.width; x++) {
+            RVO::Vector2 center = fields.origin + cellSize * RVO::Vector2(x + 0.5f, y + 0.5f);
+            blocked[y * fields.width + x] = isBlocked(polygons, areas, center, clearance);
+        }
+    }
+
+    // Dijkstra from the cells on each exit line
+    fields.distances.assign(exits.size(), vector<float>(numCells, -1.0f));
+    for (size_t e = 0; e < exits.size(); e++) {
+        vector<float>& distance = fields.distances[e];
+        priority_queue< pair<float,size_t>, vector< pair<float,size_t> >, greater< pair<float,size_t> > > queue;
+        for (size_t i = 0; i < numCells; i++) {
+            RVO::Vector2 center = fields.origin + cellSize * RVO::Vector2(i % fields.width + 0.5f, i / fields.width + 0.5f);
+            float distSq = distSqPointSegment(exits[e][0], exits[e][1], center);
+            if (!blocked[i] && distSq < cellSize * cellSize) {
+                distance[i] = sqrt(distSq);
+                queue.push(make_pair(distance[i], i));
+            }
+        }
+        if (queue.empty()) {
+            cout << "ERROR - Exit " << e << " is not reachable on the flow field grid" << endl;
+            return 1;
+        }
+
+        while (!queue.empty()) {
+            float d = queue.top().first;
+            size_t i = queue.top().second;
+            queue.pop();
+            if (d > distance[i]) {
+                continue;
+            }
+            size_t x = i % fields.width;
+            size_t y = i / fields.width;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if ((dx == 0 && dy == 0) ||
+                        (x == 0 && dx < 0) || (x + 1 == fields.width && dx > 0) ||
+                        (y == 0 && dy < 0) || (y + 1 == fields.height && dy > 0)) {
+                        continue;
+                    }
+                    size_t n = (y + dy) * fields.width + (x + dx);
+                    // Diagonal steps must not cut obstacle corners
+                    if (blocked[n] || (dx != 0 && dy != 0 &&
+                                       (blocked[y * fields.width + (x + dx)] || blocked[(y + dy) * fields.width + x]))) {
+                        continue;
+                    }
+                    float nd = d + ((dx != 0 && dy != 0) ? 1.41421356f : 1.0f) * cellSize;
+                    if (distance[n] < 0.0f || nd < distance[n]) {
+                        distance[n] = nd;
+                        queue.push(make_pair(nd, n));
+                    }
+                }
+            }
+        }
+    }
+
+    computeFlowDirections(fields);
+
+    // Return
+    return 0;
+}
+
+
+int loadFlowFields(string filename,
+                   uint64_t key,
+                   FlowFields& fields)
+{
+    ifstream inFile(filename.c_str(), ios::binary);
+    if (!inFile) {
+        return 1;
+    }
+
+    // Check header
+    char magic[8];
+    uint32_t version;
+    uint64_t fileKey;
+    float cellSize, originX, originY;
+    uint64_t width, height, numFields;
+    inFile.read(magic, sizeof(magic));
+    inFile.read((char*) &version, sizeof(version));
+    inFile.read((char*) &fileKey, sizeof(fileKey));
+    inFile.read((char*) &cellSize, sizeof(cellSize));
+    inFile.read((char*) &originX, sizeof(originX));
+    inFile.read((char*) &originY, sizeof(originY));
+    inFile.read((char*) &width, sizeof(width));
+    inFile.read((char*) &height, sizeof(height));
+    inFile.read((char*) &numFields, sizeof(numFields));
+    if (!inFile || memcmp(magic, FLOW_FIELD_MAGIC, sizeof(magic)) != 0 ||
+        version != FLOW_FIELD_VERSION || fileKey != key) {
+        return 1;
+    }
+
+    // Read distances
+    fields.cellSize = cellSize;
+    fields.origin = RVO::Vector2(originX, originY);
+    fields.width = width;
+    fields.height = height;
+    fields.distances.assign(numFields, vector<float>(width * height));
+    for (size_t e = 0; e < numFields; e++) {
+        inFile.read((char*) &fields.distances[e][0], width * height * sizeof(float));
+    }
+    if (!inFile) {
+        return 1;
+    }
+
+    computeFlowDirections(fields);
+
+    // Return
+    return 0;
+}
+
+
+int saveFlowFields(string filename,
+                   uint64_t key,
+                   const FlowFields& fields)
+{
+    ofstream outFile(filename.c_str(), ios::binary);
+    if (!outFile) {
+        return 1;
+    }
+
+    // Write header
+    float originX = fields.origin.x();
+    float originY = fields.origin.y();
+    uint64_t width = fields.width;
+    uint64_t height = fields.height;
+    uint64_t numFields = fields.distances.size();
+    outFile.write(FLOW_FIELD_MAGIC, sizeof(FLOW_FIELD_MAGIC));
+    outFile.write((const char*) &FLOW_FIELD_VERSION, sizeof(FLOW_FIELD_VERSION));
+    outFile.write((const char*) &key, sizeof(key));
+    outFile.write((const char*) &fields.cellSize, sizeof(fields.cellSize));
+    outFile.write((const char*) &originX, sizeof(originX));
+    outFile.write((const char*) &originY, sizeof(originY));
+    outFile.write((const char*) &width, sizeof(width));
+    outFile.write((const char*) &height, sizeof(height));
+    outFile.write((const char*) &numFields, sizeof(numFields));
+
+    // Write distances
+    for (size_t e = 0; e < fields.distances.size(); e++) {
+        outFile.write((const char*) &fields.distances[e][0], fields.distances[e].size() * sizeof(float));
+    }
+
+    // Return
+    return outFile ? 0 : 1;
+}
+
+
+/* Function to get the cell containing a position, clamped to the grid
+ *  Input(s):
+ *      FlowFields& fields    - navigation fields
+ *      RVO::Vector2 position - position
+ *  Output(s):
+ *      size_t                - row-major index of the cell
+ */
+static size_t getFlowCell(const FlowFields& fields,
+                          RVO::Vector2 position)
+{
+    RVO::Vector2 offset = (position - fields.origin) / fields.cellSize;
+    size_t x = offset.x() <= 0.0f ? 0 : min((size_t) offset.x(), fields.width - 1);
+    size_t y = offset.y() <= 0.0f ? 0 : min((size_t) offset.y(), fields.height - 1);
+    return y * fields.width + x;
+}
+
+
+float getFlowDistance(const FlowFields& fields,
+                      size_t exitIndex,
+                      RVO::Vector2 position)
+{
+    return fields.distances[exitIndex][getFlowCell(fields, position)];
+}
+
+
+RVO::Vector2 getFlowDirection(const FlowFields& fields,
+                              size_t exitIndex,
+                              RVO::Vector2 position)
+{
+    return fields.directions[exitIndex][getFlowCell(fields, position)];
+}
@@ -0,0 +1,132 @@
+#ifndef __FLOWFIELD_H_INCLUDED__
+#define __FLOWFIELD_H_INCLUDED__
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "RVO.h"
+
+using namespace std;
+
+/* Navigation fields toward the exits of a scene
+ *  All fields share one grid of square cells over the scene. For each exit the
+ *  grid stores the walking distance from every cell center to the exit line
+ *  (or -1 where the cell is blocked by an obstacle or unreachable), and the
+ *  unit direction of steepest descent of that distance.
+ *      RVO::Vector2 origin            - lower left corner of the grid
+ *      float cellSize                 - side length of a cell (in meters)
+ *      size_t width, height           - number of cells in x and y
+ *      vector<vector<float>> distances - per exit, row-major cell distances
+ *      vector<vector<RVO::Vector2>> directions - per exit, row-major directions
+ */
+struct FlowFields {
+    RVO::Vector2 origin;
+    float cellSize;
+    size_t width;
+    size_t height;
+    vector< vector<float> > distances;
+    vector< vector<RVO::Vector2> > directions;
+};
+
+
+/* Function to get the squared distance from a point to a line segment
+ *  Input(s):
+ *      RVO::Vector2 a, b - endpoints of the line segment
+ *      RVO::Vector2 p    - point
+ *  Output(s):
+ *      float             - squared distance between p and the segment
+ */
+float distSqPointSegment(RVO::Vector2 a,
+                         RVO::Vector2 b,
+                         RVO::Vector2 p);
+
+
+/* Function to get a key identifying the inputs of the flow fields, so that a
+ * cached file is only reused for the same scene
+ *  Input(s):
+ *      RVOSimulator* sim       - simulator with processed obstacles
+ *      vector<vector<RVO::Vector2>> exits - exit lines by endpoints
+ *      float cellSize          - side length of a cell
+ *      float clearance         - distance cells must keep from obstacles
+ *  Output(s):
+ *      uint64_t                - FNV-1a hash of the inputs
+ */
+uint64_t getFlowFieldKey(RVO::RVOSimulator* sim,
+                         const vector< vector<RVO::Vector2> >& exits,
+                         float cellSize,
+                         float clearance);
+
+
+/* Function to compute the navigation field toward each exit with Dijkstra's
+ * algorithm on the 8-connected grid
+ *  Input(s):
+ *      RVOSimulator* sim       - simulator with processed obstacles
+ *      vector<vector<RVO::Vector2>> exits - exit lines by endpoints
+ *                                 (i.e. [[(x0_0,y0_0),(x1_0,y1_0)], ...])
+ *      float cellSize          - side length of a cell (in meters)
+ *      float clearance         - distance cells must keep from obstacles
+ *  Output(s):
+ *      FlowFields& fields      - computed fields, one per exit
+ *      int                     - 0 if successful, 1 if failed
+ */
+int computeFlowFields(RVO::RVOSimulator* sim,
+                      const vector< vector<RVO::Vector2> >& exits,
+                      float cellSize,
+                      float clearance,
+                      FlowFields& fields);
+
+
+/* Function to load flow fields from a cache file
+ *  Input(s):
+ *      string filename - cache file written by saveFlowFields
+ *      uint64_t key    - key of the inputs the fields must have been built from
+ *  Output(s):
+ *      FlowFields& fields - loaded fields
+ *      int                - 0 if successful, 1 if missing, stale or corrupt
+ */
+int loadFlowFields(string filename,
+                   uint64_t key,
+                   FlowFields& fields);
+
+
+/* Function to save flow fields to a cache file
+ *  Input(s):
+ *      string filename     - cache file to be written
+ *      uint64_t key        - key of the inputs the fields were built from
+ *      FlowFields& fields  - fields to be saved
+ *  Output(s):
+ *      int                 - 0 if successful, 1 if failed
+ */
+int saveFlowFields(string filename,
+                   uint64_t key,
+                   const FlowFields& fields);
+
+
+/* Function to sample the walking distance to an exit
+ *  Input(s):
+ *      FlowFields& fields    - navigation fields
+ *      size_t exitIndex      - index of the exit
+ *      RVO::Vector2 position - position to sample (clamped to the grid)
+ *  Output(s):
+ *      float                 - distance to the exit line, or -1 in blocked
+ *                              and unreachable cells
+ */
+float getFlowDistance(const FlowFields& fields,
+                      size_t exitIndex,
+                      RVO::Vector2 position);
+
+
+/* Function to sample the direction toward an exit
+ *  Input(s):
+ *      FlowFields& fields    - navigation fields
+ *      size_t exitIndex      - index of the exit
+ *      RVO::Vector2 position - position to sample (clamped to the grid)
+ *  Output(s):
+ *      RVO::Vector2          - unit direction toward the exit, or zero on the
+ *                              exit line and in blocked cells
+ */
+RVO::Vector2 getFlowDirection(const FlowFields& fields,
+                              size_t exitIndex,
+                              RVO::Vector2 position);
+
+#endif  // __FLOWFIELD_H_INCLUDED__
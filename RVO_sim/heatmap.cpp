@@ -0,0 +1,172 @@
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+#include "heatmap.hpp"
+
+// File signature
+static const char HEATMAP_FILE_MAGIC[8] = {'R','V','O','H','E','A','T','\0'};
+
+
+int initHeatmap(RVO::RVOSimulator* sim,
+                const vector< vector<RVO::Vector2> >& entrances,
+                float cellSize,
+                HeatmapGrid& grid)
+{
+    if (!(cellSize > 0.0f)) {
+        cout << "ERROR - Heatmap cell size must be positive" << endl;
+        return 1;
+    }
+
+    // Grid over the bounding box of obstacles and entrances, plus a cell
+    vector<RVO::Vector2> points;
+    for (size_t i = 0; i < sim->getNumObstacleVertices(); i++) {
+        points.push_back(sim->getObstacleVertex(i));
+    }
+    for (size_t i = 0; i < entrances.size(); i++) {
+        points.insert(points.end(), entrances[i].begin(), entrances[i].end());
+    }
+    if (points.empty()) {
+        cout << "ERROR - Heatmap needs obstacles or entrances to cover" << endl;
+        return 1;
+    }
+    RVO::Vector2 minPoint = points[0];
+    RVO::Vector2 maxPoint = points[0];
+    for (size_t i = 1; i < points.size(); i++) {
+        minPoint = RVO::Vector2(min(minPoint.x(), points[i].x()), min(minPoint.y(), points[i].y()));
+        maxPoint = RVO::Vector2(max(maxPoint.x(), points[i].x()), max(maxPoint.y(), points[i].y()));
+    }
+    grid.cellSize = cellSize;
+    grid.origin = minPoint - RVO::Vector2(cellSize, cellSize);
+    grid.width = (size_t) ((maxPoint.x() - minPoint.x()) / cellSize) + 3;
+    grid.height = (size_t) ((maxPoint.y() - minPoint.y()) / cellSize) + 3;
+    grid.counts.assign(grid.width * grid.height, 0);
+    grid.sumVx.assign(grid.width * grid.height, 0.0f);
+    grid.sumVy.assign(grid.width * grid.height, 0.0f);
+    grid.numSteps = 0;
+
+    // Return
+    return 0;
+}
+
+
+void addHeatmapSample(HeatmapGrid& grid,
+                      RVO::Vector2 p,
+                      RVO::Vector2 v)
+{
+    float cellX = floor((p.x() - grid.origin.x()) / grid.cellSize);
+    float cellY = floor((p.y() - grid.origin.y()) / grid.cellSize);
+    if (!(cellX >= 0.0f && cellX < grid.width && cellY >= 0.0f && cellY < grid.height)) {
+        return;
+    }
+    size_t cell = (size_t) cellY * grid.width + (size_t) cellX;
+    grid.counts[cell]++;
+    grid.sumVx[cell] += v.x();
+    grid.sumVy[cell] += v.y();
+}
+
+
+void mergeHeatmap(HeatmapGrid& from,
+                  HeatmapGrid& into)
+{
+    for (size_t i = 0; i < into.counts.size(); i++) {
+        into.counts[i] += from.counts[i];
+        into.sumVx[i] += from.sumVx[i];
+        into.sumVy[i] += from.sumVy[i];
+    }
+    into.numSteps += from.numSteps;
+    clearHeatmap(from);
+}
+
+
+void clearHeatmap(HeatmapGrid& grid)
+{
+    fill(grid.counts.begin(), grid.counts.end(), 0);
+    fill(grid.sumVx.begin(), grid.sumVx.end(), 0.0f);
+    fill(grid.sumVy.begin(), grid.sumVy.end(), 0.0f);
+    grid.numSteps = 0;
+}
+
+
+int writeHeatmapImage(string filename,
+                      const HeatmapGrid& grid)
+{
+    ofstream outFile(filename.c_str(), ios::binary | ios::trunc);
+    if (!outFile.is_open()) {
+        cout << "ERROR - Unable to write heatmap to " << filename << endl;
+        return 1;
+    }
+
+    // Counts up to 65535, in 16 bits (big-endian) when they do not fit in 8
+    uint32_t maxCount = 1;
+    for (size_t i = 0; i < grid.counts.size(); i++) {
+        maxCount = max(maxCount, grid.counts[i]);
+    }
+    maxCount = min(maxCount, (uint32_t) 65535);
+    outFile << "P5\n" << grid.width << " " << grid.height << "\n" << maxCount << "\n";
+
+    // Rows from the top of the scene down
+    vector<unsigned char> row;
+    for (size_t y = grid.height; y-- > 0; ) {
+        row.clear();
+        for (size_t x = 0; x < grid.width; x++) {
+            uint32_t count = min(grid.counts[y * grid.width + x], maxCount);
+            if (maxCount > 255) {
+                row.push_back((unsigned char) (count >> 8));
+            }
+            row.push_back((unsigned char) count);
+        }
+        outFile.write((const char*) &row[0], row.size());
+    }
+    outFile.close();
+
+    // Return
+    return outFile.fail() ? 1 : 0;
+}
+
+
+int writeHeatmapFile(string filename,
+                     const HeatmapGrid& grid,
+                     double startTime,
+                     double endTime)
+{
+    ofstream outFile(filename.c_str(), ios::binary | ios::trunc);
+    if (!outFile.is_open()) {
+        cout << "ERROR - Unable to write heatmap to " << filename << endl;
+        return 1;
+    }
+
+    // Header
+    HeatmapFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HEATMAP_FILE_MAGIC, sizeof(header.magic));
+    header.version = HEATMAP_FILE_VERSION;
+    header.width = (uint32_t) grid.width;
+    header.height = (uint32_t) grid.height;
+    header.numSteps = grid.numSteps;
+    header.originX = grid.origin.x();
+    header.originY = grid.origin.y();
+    header.cellSize = grid.cellSize;
+    header.startTime = startTime;
+    header.endTime = endTime;
+    outFile.write((const char*) &header, sizeof(header));
+
+    // Counts, then mean velocities
+    size_t numCells = grid.counts.size();
+    outFile.write((const char*) &grid.counts[0], numCells * sizeof(uint32_t));
+    vector<float> meanVx(numCells, 0.0f), meanVy(numCells, 0.0f);
+    for (size_t i = 0; i < numCells; i++) {
+        if (grid.counts[i] > 0) {
+            meanVx[i] = grid.sumVx[i] / grid.counts[i];
+            meanVy[i] = grid.sumVy[i] / grid.counts[i];
+        }
+    }
+    outFile.write((const char*) &meanVx[0], numCells * sizeof(float));
+    outFile.write((const char*) &meanVy[0], numCells * sizeof(float));
+    outFile.close();
+
+    // Return
+    return outFile.fail() ? 1 : 0;
+}
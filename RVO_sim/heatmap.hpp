@@ -0,0 +1,127 @@
+#ifndef __HEATMAP_H_INCLUDED__
+#define __HEATMAP_H_INCLUDED__
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "RVO.h"
+
+using namespace std;
+
+/* Occupancy and velocity of agents binned on a grid over the scene
+ *  Each sample of an agent adds 1 to the count of the cell it is in and its
+ *  velocity to the cell's sums. Samples outside the grid are dropped.
+ *      RVO::Vector2 origin     - lower left corner of the grid
+ *      float cellSize          - side length of a cell (in meters)
+ *      size_t width, height    - number of cells in x and y
+ *      vector<uint32_t> counts - row-major number of samples per cell
+ *      vector<float> sumVx, sumVy - row-major summed velocities per cell
+ *      uint32_t numSteps       - time steps sampled into the grid
+ */
+struct HeatmapGrid {
+    RVO::Vector2 origin;
+    float cellSize;
+    size_t width;
+    size_t height;
+    uint32_t numSteps;
+    vector<uint32_t> counts;
+    vector<float> sumVx;
+    vector<float> sumVy;
+};
+
+
+/* Binary heatmap file (.heat)
+ *  The header is followed by width*height uint32 counts, then the mean x and
+ *  the mean y velocity of each cell as floats (0 where the count is 0), all
+ *  row-major starting from the row at the origin. numSteps is the number of
+ *  time steps sampled in the window.
+ */
+static const uint32_t HEATMAP_FILE_VERSION = 1;
+
+struct HeatmapFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t numSteps;
+    double originX;
+    double originY;
+    double cellSize;
+    double startTime;
+    double endTime;
+};
+
+
+/* Function to create an empty grid over the obstacles and entrances of a scene
+ *  Input(s):
+ *      RVOSimulator* sim     - simulator with processed obstacles
+ *      vector<vector<RVO::Vector2>> entrances - entrance/exit lines by endpoints
+ *      float cellSize        - side length of a cell (in meters)
+ *  Output(s):
+ *      HeatmapGrid& grid     - empty grid
+ *      int                   - 0 if successful, 1 if the cell size is not positive
+ */
+int initHeatmap(RVO::RVOSimulator* sim,
+                const vector< vector<RVO::Vector2> >& entrances,
+                float cellSize,
+                HeatmapGrid& grid);
+
+
+/* Function to add a sample of an agent
+ *  Input(s):
+ *      RVO::Vector2 p        - position of the agent
+ *      RVO::Vector2 v        - velocity of the agent
+ *  Output(s):
+ *      HeatmapGrid& grid     - updated grid
+ */
+void addHeatmapSample(HeatmapGrid& grid,
+                      RVO::Vector2 p,
+                      RVO::Vector2 v);
+
+
+/* Function to add the samples of a grid to another of the same size, and
+ * clear it
+ *  Input(s):
+ *      HeatmapGrid& from     - grid to be added
+ *  Output(s):
+ *      HeatmapGrid& from     - empty grid
+ *      HeatmapGrid& into     - sum of both grids
+ */
+void mergeHeatmap(HeatmapGrid& from,
+                  HeatmapGrid& into);
+
+
+/* Function to remove all samples from a grid
+ *  Input(s):
+ *      HeatmapGrid& grid     - grid
+ *  Output(s):
+ *      HeatmapGrid& grid     - empty grid
+ */
+void clearHeatmap(HeatmapGrid& grid);
+
+
+/* Function to write the counts of a grid as a binary PGM image, north up
+ *  Input(s):
+ *      string filename       - file to be written
+ *      HeatmapGrid& grid     - grid
+ *  Output(s):
+ *      int                   - 0 if successful, 1 if failed
+ */
+int writeHeatmapImage(string filename,
+                      const HeatmapGrid& grid);
+
+
+/* Function to write the counts and mean velocities of a grid to a .heat file
+ *  Input(s):
+ *      string filename       - file to be written
+ *      HeatmapGrid& grid     - grid
+ *      double startTime, endTime - time window of the samples (in seconds)
+ *  Output(s):
+ *      int                   - 0 if successful, 1 if failed
+ */
+int writeHeatmapFile(string filename,
+                     const HeatmapGrid& grid,
+                     double startTime,
+                     double endTime);
+
+#endif  // __HEATMAP_H_INCLUDED__
@@ -0,0 +1,193 @@
+#include <iostream>
+
+#include "layouts.hpp"
+#include "camera.hpp"
+
+// Tracks evaluated against all layouts before moving on to the next ones
+static const size_t LAYOUT_TRACK_BLOCK = 256;
+
+
+/* Cameras of a layout, prepared for testing points
+ *      CameraFOVs fovs         - compiled fields of view
+ *      vector<CameraVisibility> visibilities - line of sight of each camera
+ */
+struct CameraLayout {
+    CameraFOVs fovs;
+    vector<CameraVisibility> visibilities;
+};
+
+
+/* Function to add a block of tracks to the scores of a layout
+ *  Input(s):
+ *      RVOSimulator* sim     - simulator with processed obstacles
+ *      CameraLayout& layout  - prepared cameras
+ *      vector<vector<RVO::Real>> tracks - ground truth tracks
+ *      size_t firstTrack, endTrack - range of tracks to be added
+ *  Output(s):
+ *      LayoutScores& scores  - updated scores
+ */
+static void scoreTracks(RVO::RVOSimulator* sim,
+                        const CameraLayout& layout,
+                        const vector< vector<RVO::Real> >& tracks,
+                        size_t firstTrack,
+                        size_t endTrack,
+                        LayoutScores& scores)
+{
+    size_t numCams = scores.numCameras;
+    vector<size_t> pointCameras;
+    vector<size_t> cameras;
+    vector<size_t> prevCams, curCams;
+    vector<bool> inCam(numCams, false), nowInCam(numCams, false);
+    vector<double> startTimes(numCams, 0.0);
+
+    for (size_t j = firstTrack; j < endTrack; j++) {
+        const vector<RVO::Real>& track = tracks[j];
+        size_t numPoints = track.size()/3-1;
+        scores.numTracks++;
+        if (numPoints == 0) {
+            continue;
+        }
+        getCamerasContaining(layout.fovs, &track[0] + 3, 3, numPoints, pointCameras, cameras);
+
+        bool seen = false;
+        int lastCam = -1;
+        double prevTime = 0.0;
+        for (size_t i = 0; i < numPoints; i++) {
+            RVO::Vector2 p = RVO::Vector2(track[3*(i+1)], track[3*(i+1) + 1]);
+            double t = track[3*(i+1) + 2];
+
+            // Cameras seeing the point
+            curCams.clear();
+            for (size_t k = pointCameras[i]; k < pointCameras[i+1]; k++) {
+                if (isVisibleFromCamera(sim, layout.visibilities[cameras[k]], p)) {
+                    curCams.push_back(cameras[k]);
+                }
+            }
+
+            // Coverage and overlap
+            scores.numPoints++;
+            if (curCams.size() >= 1) {
+                scores.coveredPoints++;
+                seen = true;
+            }
+            if (curCams.size() >= 2) {
+                scores.overlapPoints++;
+                for (size_t a = 0; a < curCams.size(); a++) {
+                    for (size_t b = a+1; b < curCams.size(); b++) {
+                        scores.pairOverlap[curCams[a]*numCams + curCams[b]]++;
+                    }
+                }
+            }
+
+            // End the tracklets of cameras that lost the point
+            for (size_t k = 0; k < curCams.size(); k++) {
+                nowInCam[curCams[k]] = true;
+            }
+            for (size_t k = 0; k < prevCams.size(); k++) {
+                if (!nowInCam[prevCams[k]]) {
+                    scores.trackletTime += prevTime - startTimes[prevCams[k]];
+                    inCam[prevCams[k]] = false;
+                }
+            }
+
+            // Start tracklets in cameras that gained it, each a transition from
+            // the camera of the previous tracklet
+            int newLastCam = lastCam;
+            for (size_t k = 0; k < curCams.size(); k++) {
+                size_t cam = curCams[k];
+                nowInCam[cam] = false;
+                if (inCam[cam]) {
+                    continue;
+                }
+                inCam[cam] = true;
+                startTimes[cam] = t;
+                scores.numTracklets++;
+                if (lastCam >= 0 && (size_t) lastCam != cam) {
+                    scores.numTransitions++;
+                    scores.pairTransitions[lastCam*numCams + cam]++;
+                }
+                newLastCam = cam;
+            }
+            lastCam = newLastCam;
+
+            prevCams.swap(curCams);
+            prevTime = t;
+        }
+
+        // End the tracklets still open at the end of the track
+        for (size_t k = 0; k < prevCams.size(); k++) {
+            scores.trackletTime += prevTime - startTimes[prevCams[k]];
+            inCam[prevCams[k]] = false;
+        }
+        prevCams.clear();
+        if (seen) {
+            scores.coveredTracks++;
+        }
+    }
+}
+
+
+int evaluateLayouts(RVO::RVOSimulator* sim,
+                    const vector< vector<RVO::Real> >& tracks,
+                    const vector< vector<RVO::Vector2> >& centers,
+                    const vector< vector< vector<RVO::Vector2> > >& polygons,
+                    vector<LayoutScores>& scores)
+{
+    int numLayouts = static_cast<int>(polygons.size());
+
+    // Prepare the cameras of each layout and clear its scores
+    vector<CameraLayout> layouts(numLayouts);
+    scores.assign(numLayouts, LayoutScores());
+    int numFailed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(+:numFailed)
+#endif
+    for (int l = 0; l < numLayouts; l++) {
+        size_t numCams = polygons[l].size();
+        if (compileCameraFOVs(polygons[l], layouts[l].fovs)) {
+            numFailed++;
+            continue;
+        }
+        layouts[l].visibilities.resize(numCams);
+        for (size_t i = 0; i < numCams; i++) {
+            float range = 0.0f;
+            for (size_t j = 0; j < polygons[l][i].size(); j++) {
+                float dist = abs(polygons[l][i][j] - centers[l][i]);
+                if (dist > range) {
+                    range = dist;
+                }
+            }
+            computeCameraVisibility(sim, centers[l][i], range, layouts[l].visibilities[i]);
+        }
+
+        LayoutScores& layoutScores = scores[l];
+        layoutScores.numCameras = numCams;
+        layoutScores.numPoints = 0;
+        layoutScores.coveredPoints = 0;
+        layoutScores.overlapPoints = 0;
+        layoutScores.numTracks = 0;
+        layoutScores.coveredTracks = 0;
+        layoutScores.numTracklets = 0;
+        layoutScores.trackletTime = 0.0;
+        layoutScores.numTransitions = 0;
+        layoutScores.pairOverlap.assign(numCams*numCams, 0);
+        layoutScores.pairTransitions.assign(numCams*numCams, 0);
+    }
+    if (numFailed > 0) {
+        return 1;
+    }
+
+    // Stream the tracks in blocks, each evaluated against all layouts in parallel
+    for (size_t first = 0; first < tracks.size(); first += LAYOUT_TRACK_BLOCK) {
+        size_t end = min(first + LAYOUT_TRACK_BLOCK, tracks.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (int l = 0; l < numLayouts; l++) {
+            scoreTracks(sim, layouts[l], tracks, first, end, scores[l]);
+        }
+    }
+
+    // Return
+    return 0;
+}
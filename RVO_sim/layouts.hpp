@@ -0,0 +1,65 @@
+#ifndef __LAYOUTS_H_INCLUDED__
+#define __LAYOUTS_H_INCLUDED__
+
+#include <vector>
+#include <stdint.h>
+#include "RVO.h"
+
+using namespace std;
+
+/* Scores of a candidate camera layout over a set of tracks
+ *  A point is seen by a camera when it is inside the camera's field of view
+ *  and in its line of sight. A tracklet is a run of consecutive points of a
+ *  track seen by the same camera, and a transition is a tracklet starting in
+ *  a different camera than the track's previous tracklet.
+ *      size_t numCameras       - cameras in the layout
+ *      uint64_t numPoints      - track points evaluated
+ *      uint64_t coveredPoints  - points seen by at least one camera
+ *      uint64_t overlapPoints  - points seen by at least two cameras
+ *      uint64_t numTracks      - tracks evaluated
+ *      uint64_t coveredTracks  - tracks seen by at least one camera
+ *      uint64_t numTracklets   - tracklets over all cameras
+ *      double trackletTime     - summed duration of the tracklets (in seconds)
+ *      uint64_t numTransitions - transitions between cameras
+ *      vector<uint64_t> pairOverlap     - points seen by both cameras i < j,
+ *                                         at [i*numCameras + j]
+ *      vector<uint64_t> pairTransitions - transitions from camera i to camera j,
+ *                                         at [i*numCameras + j]
+ */
+struct LayoutScores {
+    size_t numCameras;
+    uint64_t numPoints;
+    uint64_t coveredPoints;
+    uint64_t overlapPoints;
+    uint64_t numTracks;
+    uint64_t coveredTracks;
+    uint64_t numTracklets;
+    double trackletTime;
+    uint64_t numTransitions;
+    vector<uint64_t> pairOverlap;
+    vector<uint64_t> pairTransitions;
+};
+
+
+/* Function to score candidate camera layouts against the same tracks
+ *  The tracks are streamed once, in blocks; each block is evaluated against
+ *  all layouts in parallel (with OpenMP) before moving on to the next.
+ *  Input(s):
+ *      RVOSimulator* sim     - simulator with processed obstacles
+ *      vector<vector<RVO::Real>> tracks - ground truth tracks, each a row of
+ *                                         3 header values followed by x,y,t
+ *                                         triples (t in seconds)
+ *      vector<vector<RVO::Vector2>> centers - center of each camera of each layout
+ *      vector<vector<vector<RVO::Vector2>>> polygons - convex field of view of
+ *                                         each camera of each layout, in world coords
+ *  Output(s):
+ *      vector<LayoutScores>& scores - scores of each layout
+ *      int                   - 0 if successful, 1 if a polygon is not convex
+ */
+int evaluateLayouts(RVO::RVOSimulator* sim,
+                    const vector< vector<RVO::Real> >& tracks,
+                    const vector< vector<RVO::Vector2> >& centers,
+                    const vector< vector< vector<RVO::Vector2> > >& polygons,
+                    vector<LayoutScores>& scores);
+
+#endif  // __LAYOUTS_H_INCLUDED__
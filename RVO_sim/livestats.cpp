@@ -0,0 +1,303 @@
+#include <iostream>
+#include <cstring>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "livestats.hpp"
+
+// Region signature
+static const char LIVE_STATS_MAGIC[8] = {'R','V','O','L','I','V','E','\0'};
+
+
+/* Function to get the size of the shared region
+ *  Output(s):
+ *      size_t              - size of the header, ring and snapshot (in bytes)
+ */
+static size_t getLiveStatsSize()
+{
+    return sizeof(LiveHeader) + LIVE_NUM_SLOTS * sizeof(LiveStatsRecord) +
+           2 * LIVE_MAX_POSITIONS * sizeof(float);
+}
+
+
+/* Function to get the POSIX name of a region
+ *  Input(s):
+ *      string name         - name of the region
+ *  Output(s):
+ *      string              - name with a leading /
+ */
+static string getLiveStatsName(string name)
+{
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+
+/* Function to write a record with the statistics since the previous one
+ *  Input(s):
+ *      LiveStats& live     - opened live statistics
+ *      double now          - wall clock (in seconds)
+ *      uint64_t step, simTime, activeAgents, totalAgents - see endLiveStep
+ */
+static void publishLiveStats(LiveStats& live,
+                             double now,
+                             uint64_t step,
+                             double simTime,
+                             uint32_t activeAgents,
+                             uint32_t totalAgents)
+{
+    uint64_t index = live.header->numRecords;
+    LiveStatsRecord* slot = &live.slots[index % LIVE_NUM_SLOTS];
+
+    // Odd seq while the slot is being written
+    __atomic_store_n(&slot->seq, 2*index + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->step = step;
+    slot->simTime = simTime;
+    slot->wallTime = now - live.startTime;
+    slot->stepRate = (now > live.recordTime) ? live.steps / (now - live.recordTime) : 0.0;
+    slot->activeAgents = activeAgents;
+    slot->totalAgents = totalAgents;
+    for (int p = 0; p < LIVE_NUM_PHASES; p++) {
+        slot->phaseTimes[p] = (live.steps > 0) ? 1000.0 * live.phaseTimes[p] / live.steps : 0.0;
+        live.phaseTimes[p] = 0.0;
+    }
+    __atomic_store_n(&slot->seq, 2*index + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&live.header->numRecords, index + 1, __ATOMIC_RELEASE);
+
+    live.steps = 0;
+    live.recordTime = now;
+}
+
+
+double getLiveWallTime()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void initLiveStats(LiveStats& live)
+{
+    live.name.clear();
+    live.data = NULL;
+    live.size = 0;
+    live.header = NULL;
+    live.slots = NULL;
+    live.positions = NULL;
+}
+
+
+int openLiveStats(string name,
+                  LiveStats& live)
+{
+    initLiveStats(live);
+    live.name = getLiveStatsName(name);
+    live.size = getLiveStatsSize();
+
+    // Create a fresh region, zero filled
+    shm_unlink(live.name.c_str());
+    int fd = shm_open(live.name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        cout << "ERROR - Unable to create shared memory " << live.name << endl;
+        return 1;
+    }
+    if (ftruncate(fd, live.size) != 0) {
+        close(fd);
+        shm_unlink(live.name.c_str());
+        cout << "ERROR - Unable to size shared memory " << live.name << endl;
+        return 1;
+    }
+    void* data = mmap(NULL, live.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        shm_unlink(live.name.c_str());
+        cout << "ERROR - Unable to map shared memory " << live.name << endl;
+        return 1;
+    }
+    live.data = (char*) data;
+    live.header = (LiveHeader*) live.data;
+    live.slots = (LiveStatsRecord*) (live.data + sizeof(LiveHeader));
+    live.positions = (float*) (live.data + sizeof(LiveHeader) +
+                               LIVE_NUM_SLOTS * sizeof(LiveStatsRecord));
+
+    // Header, with the signature last so viewers only see a complete one
+    live.header->version = LIVE_STATS_VERSION;
+    live.header->numSlots = LIVE_NUM_SLOTS;
+    live.header->maxPositions = LIVE_MAX_POSITIONS;
+    live.header->pid = getpid();
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(live.header->magic, LIVE_STATS_MAGIC, sizeof(LIVE_STATS_MAGIC));
+
+    live.steps = 0;
+    for (int p = 0; p < LIVE_NUM_PHASES; p++) {
+        live.phaseTimes[p] = 0.0;
+    }
+    live.startTime = getLiveWallTime();
+    live.markTime = live.startTime;
+    live.recordTime = live.startTime;
+
+    // Return
+    return 0;
+}
+
+
+void markLivePhase(LiveStats& live,
+                   LivePhase phase)
+{
+    if (live.data == NULL) {
+        return;
+    }
+    double now = getLiveWallTime();
+    live.phaseTimes[phase] += now - live.markTime;
+    live.markTime = now;
+}
+
+
+void endLiveStep(LiveStats& live,
+                 uint64_t step,
+                 double simTime,
+                 uint32_t activeAgents,
+                 uint32_t totalAgents)
+{
+    if (live.data == NULL) {
+        return;
+    }
+    live.steps++;
+    if (live.markTime - live.recordTime >= LIVE_STATS_INTERVAL) {
+        publishLiveStats(live, live.markTime, step, simTime, activeAgents, totalAgents);
+    }
+}
+
+
+void publishLivePositions(LiveStats& live,
+                          const vector<float>& coords,
+                          double simTime)
+{
+    if (live.data == NULL) {
+        return;
+    }
+    uint32_t numPositions = (uint32_t) min(coords.size() / 2, (size_t) LIVE_MAX_POSITIONS);
+    uint64_t seq = live.header->positionsSeq;
+
+    // Odd seq while the snapshot is being written
+    __atomic_store_n(&live.header->positionsSeq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    if (numPositions > 0) {
+        memcpy(live.positions, &coords[0], 2 * numPositions * sizeof(float));
+    }
+    live.header->numPositions = numPositions;
+    live.header->positionsTime = simTime;
+    __atomic_store_n(&live.header->positionsSeq, seq + 2, __ATOMIC_RELEASE);
+}
+
+
+void closeLiveStats(LiveStats& live)
+{
+    if (live.data == NULL) {
+        return;
+    }
+    __atomic_store_n(&live.header->finished, 1, __ATOMIC_RELEASE);
+    munmap(live.data, live.size);
+    shm_unlink(live.name.c_str());
+    initLiveStats(live);
+}
+
+
+int attachLiveStats(string name,
+                    LiveStatsView& view)
+{
+    memset(&view, 0, sizeof(view));
+
+    int fd = shm_open(getLiveStatsName(name).c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size != getLiveStatsSize()) {
+        close(fd);
+        return 1;
+    }
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return 1;
+    }
+    view.data = (const char*) data;
+    view.size = st.st_size;
+    view.header = (const LiveHeader*) view.data;
+    view.slots = (const LiveStatsRecord*) (view.data + sizeof(LiveHeader));
+    view.positions = (const float*) (view.data + sizeof(LiveHeader) +
+                                     LIVE_NUM_SLOTS * sizeof(LiveStatsRecord));
+
+    // Check the signature before the rest of the header
+    bool valid = memcmp(view.header->magic, LIVE_STATS_MAGIC, sizeof(LIVE_STATS_MAGIC)) == 0;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (!valid ||
+        view.header->version != LIVE_STATS_VERSION ||
+        view.header->numSlots != LIVE_NUM_SLOTS ||
+        view.header->maxPositions != LIVE_MAX_POSITIONS) {
+        detachLiveStats(view);
+        return 1;
+    }
+
+    // Return
+    return 0;
+}
+
+
+int readLiveStats(const LiveStatsView& view,
+                  uint64_t index,
+                  LiveStatsRecord& record)
+{
+    if (index >= __atomic_load_n(&view.header->numRecords, __ATOMIC_ACQUIRE)) {
+        return 1;
+    }
+    const LiveStatsRecord* slot = &view.slots[index % LIVE_NUM_SLOTS];
+    uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq != 2*index + 2) {
+        return 1;
+    }
+    memcpy(&record, (const void*) slot, sizeof(record));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    // Return
+    return (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) ? 0 : 1;
+}
+
+
+int readLivePositions(const LiveStatsView& view,
+                      vector<float>& coords,
+                      double& simTime)
+{
+    // Retry a few times if the simulator writes a new snapshot meanwhile
+    for (int attempt = 0; attempt < 4; attempt++) {
+        uint64_t seq = __atomic_load_n(&view.header->positionsSeq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            continue;
+        }
+        uint32_t numPositions = min(view.header->numPositions, LIVE_MAX_POSITIONS);
+        simTime = view.header->positionsTime;
+        coords.resize(2 * numPositions);
+        if (numPositions > 0) {
+            memcpy(&coords[0], view.positions, 2 * numPositions * sizeof(float));
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&view.header->positionsSeq, __ATOMIC_RELAXED) == seq) {
+            return 0;
+        }
+    }
+
+    // Return
+    return 1;
+}
+
+
+void detachLiveStats(LiveStatsView& view)
+{
+    if (view.data != NULL) {
+        munmap((void*) view.data, view.size);
+    }
+    memset(&view, 0, sizeof(view));
+}
@@ -0,0 +1,234 @@
+#ifndef __LIVESTATS_H_INCLUDED__
+#define __LIVESTATS_H_INCLUDED__
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/* Live statistics of a running simulation in POSIX shared memory
+ *  The simulator creates the region and is its only writer; viewers map it
+ *  read-only and may attach and detach at any time without the simulator
+ *  noticing. The region holds a LiveHeader, a ring of LIVE_NUM_SLOTS
+ *  LiveStatsRecords and room for LIVE_MAX_POSITIONS (x,y) float pairs.
+ *
+ *  Record i goes to slot i % LIVE_NUM_SLOTS. Its seq is 2i+1 while it is
+ *  written and 2i+2 once done, after which the header's numRecords becomes
+ *  i+1. A reader copies a slot and keeps the copy only if seq was 2i+2 both
+ *  before and after. The position snapshot is guarded the same way by
+ *  positionsSeq (odd while written).
+ */
+static const uint32_t LIVE_STATS_VERSION = 1;
+static const uint32_t LIVE_NUM_SLOTS = 256;
+static const uint32_t LIVE_MAX_POSITIONS = 65536;
+
+// Seconds between published records
+static const double LIVE_STATS_INTERVAL = 0.1;
+
+// Phases of a simulation step
+enum LivePhase {
+    LIVE_PHASE_AGENTS,          // adding agents
+    LIVE_PHASE_RECORD,          // recording tracks, transitions, heatmaps
+    LIVE_PHASE_VELOCITIES,      // setting preferred velocities
+    LIVE_PHASE_STEP,            // RVOSimulator::doStep
+    LIVE_NUM_PHASES
+};
+
+
+/* Header of the shared region
+ *      char magic[8]           - "RVOLIVE"
+ *      uint32_t version, numSlots, maxPositions - layout of the region
+ *      int32_t pid             - process id of the simulator
+ *      uint64_t numRecords     - records published so far
+ *      uint64_t positionsSeq   - odd while the snapshot is being written
+ *      uint32_t numPositions   - agents in the snapshot
+ *      uint32_t finished       - 1 once the simulation has ended
+ *      double positionsTime    - simulation time of the snapshot (in seconds)
+ */
+struct LiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numSlots;
+    uint32_t maxPositions;
+    int32_t pid;
+    uint64_t numRecords;
+    uint64_t positionsSeq;
+    uint32_t numPositions;
+    uint32_t finished;
+    double positionsTime;
+};
+
+
+/* Statistics over the steps since the previous record
+ *      uint64_t seq            - see above
+ *      uint64_t step           - steps simulated so far
+ *      double simTime          - simulation time (in seconds)
+ *      double wallTime         - time since the simulator started (in seconds)
+ *      double stepRate         - steps per second
+ *      uint32_t activeAgents, totalAgents - agents walking, agents created
+ *      double phaseTimes[]     - mean time per step in each phase (in ms)
+ */
+struct LiveStatsRecord {
+    uint64_t seq;
+    uint64_t step;
+    double simTime;
+    double wallTime;
+    double stepRate;
+    uint32_t activeAgents;
+    uint32_t totalAgents;
+    double phaseTimes[LIVE_NUM_PHASES];
+};
+
+
+/* Simulator side of the shared region
+ *      string name             - name of the region
+ *      char* data; size_t size - mapping of the region (NULL when disabled)
+ *      LiveHeader* header; LiveStatsRecord* slots; float* positions - parts of it
+ *      uint64_t steps          - steps since the previous record
+ *      double phaseTimes[]     - time spent in each phase since the previous record
+ *      double startTime, markTime, recordTime - wall clock at the start, the
+ *                                last phase mark and the previous record
+ */
+struct LiveStats {
+    string name;
+    char* data;
+    size_t size;
+    LiveHeader* header;
+    LiveStatsRecord* slots;
+    float* positions;
+    uint64_t steps;
+    double phaseTimes[LIVE_NUM_PHASES];
+    double startTime;
+    double markTime;
+    double recordTime;
+};
+
+
+/* Viewer side of the shared region
+ *      char* data; size_t size - read-only mapping of the region
+ *      LiveHeader* header; LiveStatsRecord* slots; float* positions - parts of it
+ */
+struct LiveStatsView {
+    const char* data;
+    size_t size;
+    const LiveHeader* header;
+    const LiveStatsRecord* slots;
+    const float* positions;
+};
+
+
+/* Function to get a monotonic wall clock
+ *  Output(s):
+ *      double              - time (in seconds)
+ */
+double getLiveWallTime();
+
+
+/* Function to mark a LiveStats as disabled, so that the other functions
+ * do nothing
+ *  Output(s):
+ *      LiveStats& live     - disabled live statistics
+ */
+void initLiveStats(LiveStats& live);
+
+
+/* Function to create the shared region, replacing any left over
+ *  Input(s):
+ *      string name         - name of the region (a leading / is added if missing)
+ *  Output(s):
+ *      LiveStats& live     - opened live statistics
+ *      int                 - 0 if successful, 1 if failed
+ */
+int openLiveStats(string name,
+                  LiveStats& live);
+
+
+/* Function to add the time since the previous mark to a phase
+ *  Input(s):
+ *      LiveStats& live     - live statistics
+ *      LivePhase phase     - phase that just ended
+ */
+void markLivePhase(LiveStats& live,
+                   LivePhase phase);
+
+
+/* Function to count a finished step and publish a record when
+ * LIVE_STATS_INTERVAL has passed since the previous one
+ *  Input(s):
+ *      LiveStats& live     - live statistics
+ *      uint64_t step       - steps simulated so far
+ *      double simTime      - simulation time (in seconds)
+ *      uint32_t activeAgents, totalAgents - agents walking, agents created
+ */
+void endLiveStep(LiveStats& live,
+                 uint64_t step,
+                 double simTime,
+                 uint32_t activeAgents,
+                 uint32_t totalAgents);
+
+
+/* Function to publish a snapshot of agent positions
+ *  Input(s):
+ *      LiveStats& live     - live statistics
+ *      vector<float> coords - x,y of each agent (only the first
+ *                             LIVE_MAX_POSITIONS are kept)
+ *      double simTime      - simulation time (in seconds)
+ */
+void publishLivePositions(LiveStats& live,
+                          const vector<float>& coords,
+                          double simTime);
+
+
+/* Function to mark the simulation as finished and remove the region
+ *  Input(s):
+ *      LiveStats& live     - live statistics
+ */
+void closeLiveStats(LiveStats& live);
+
+
+/* Function to attach to the region of a running simulator
+ *  Input(s):
+ *      string name         - name of the region (a leading / is added if missing)
+ *  Output(s):
+ *      LiveStatsView& view - attached view
+ *      int                 - 0 if successful, 1 if missing or not a live region
+ */
+int attachLiveStats(string name,
+                    LiveStatsView& view);
+
+
+/* Function to copy a published record
+ *  Input(s):
+ *      LiveStatsView& view - attached view
+ *      uint64_t index      - record number
+ *  Output(s):
+ *      LiveStatsRecord& record - copy of the record
+ *      int                 - 0 if successful, 1 if it is not published yet or
+ *                            has been overwritten
+ */
+int readLiveStats(const LiveStatsView& view,
+                  uint64_t index,
+                  LiveStatsRecord& record);
+
+
+/* Function to copy the latest position snapshot
+ *  Input(s):
+ *      LiveStatsView& view - attached view
+ *  Output(s):
+ *      vector<float>& coords - x,y of each agent in the snapshot
+ *      double& simTime     - simulation time of the snapshot (in seconds)
+ *      int                 - 0 if successful, 1 if it kept changing while copied
+ */
+int readLivePositions(const LiveStatsView& view,
+                      vector<float>& coords,
+                      double& simTime);
+
+
+/* Function to detach from the region
+ *  Input(s):
+ *      LiveStatsView& view - attached view
+ */
+void detachLiveStats(LiveStatsView& view);
+
+#endif  // __LIVESTATS_H_INCLUDED__
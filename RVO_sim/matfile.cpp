@@ -0,0 +1,126 @@
+#include <iostream>
+#include <cstring>
+
+#include "matfile.hpp"
+
+// Data types and array classes of the Level 5 format
+static const uint32_t MI_INT8 = 1;
+static const uint32_t MI_INT32 = 5;
+static const uint32_t MI_UINT32 = 6;
+static const uint32_t MI_DOUBLE = 9;
+static const uint32_t MI_MATRIX = 14;
+static const uint32_t MX_DOUBLE_CLASS = 6;
+
+
+/* Function to write the tag of a data element
+ *  Input(s):
+ *      ofstream& out       - file being written
+ *      uint32_t type       - data type of the element
+ *      uint32_t numBytes   - size of the element's data (without padding)
+ */
+static void writeMatTag(ofstream& out,
+                        uint32_t type,
+                        uint32_t numBytes)
+{
+    out.write((const char*) &type, sizeof(type));
+    out.write((const char*) &numBytes, sizeof(numBytes));
+}
+
+
+int openMatFile(string filename,
+                MatFile& file)
+{
+    file.out.open(filename.c_str(), ios::binary | ios::trunc);
+    if (!file.out.is_open()) {
+        cout << "ERROR - Unable to write MAT-file " << filename << endl;
+        return 1;
+    }
+    file.remaining = 0;
+
+    // 116 bytes of text, 8 bytes of subsystem offset, version and endian flag
+    char header[128];
+    memset(header, ' ', 116);
+    const char* text = "MATLAB 5.0 MAT-file, Platform: RVO_sim";
+    memcpy(header, text, strlen(text));
+    memset(header + 116, 0, 8);
+    uint16_t version = 0x0100;
+    memcpy(header + 124, &version, sizeof(version));
+    header[126] = 'I';
+    header[127] = 'M';
+    file.out.write(header, sizeof(header));
+
+    // Return
+    return file.out.good() ? 0 : 1;
+}
+
+
+int beginMatVariable(MatFile& file,
+                     string name,
+                     size_t rows,
+                     size_t cols)
+{
+    if (file.remaining != 0) {
+        cout << "ERROR - MAT-file variable started before the previous one ended" << endl;
+        return 1;
+    }
+
+    // Array flags, dimensions, padded name and the real part
+    uint64_t namePadded = (name.size() + 7) / 8 * 8;
+    uint64_t dataBytes = (uint64_t) rows * cols * sizeof(double);
+    uint64_t matrixBytes = 16 + 16 + 8 + namePadded + 8 + dataBytes;
+    if (matrixBytes > 0xFFFFFFFFull || rows > 0x7FFFFFFF || cols > 0x7FFFFFFF) {
+        cout << "ERROR - MAT-file variable " << name << " is too large" << endl;
+        return 1;
+    }
+
+    writeMatTag(file.out, MI_MATRIX, (uint32_t) matrixBytes);
+
+    uint32_t flags[2] = {MX_DOUBLE_CLASS, 0};
+    writeMatTag(file.out, MI_UINT32, sizeof(flags));
+    file.out.write((const char*) flags, sizeof(flags));
+
+    int32_t dims[2] = {(int32_t) rows, (int32_t) cols};
+    writeMatTag(file.out, MI_INT32, sizeof(dims));
+    file.out.write((const char*) dims, sizeof(dims));
+
+    char padding[8] = {0};
+    writeMatTag(file.out, MI_INT8, (uint32_t) name.size());
+    file.out.write(name.data(), name.size());
+    file.out.write(padding, namePadded - name.size());
+
+    writeMatTag(file.out, MI_DOUBLE, (uint32_t) dataBytes);
+    file.remaining = (uint64_t) rows * cols;
+
+    // Return
+    return file.out.good() ? 0 : 1;
+}
+
+
+int writeMatValues(MatFile& file,
+                   const double* values,
+                   size_t count)
+{
+    if (count > file.remaining) {
+        cout << "ERROR - Too many values for MAT-file variable" << endl;
+        return 1;
+    }
+    file.out.write((const char*) values, count * sizeof(double));
+    file.remaining -= count;
+
+    // Return
+    return file.out.good() ? 0 : 1;
+}
+
+
+int closeMatFile(MatFile& file)
+{
+    if (file.remaining != 0) {
+        cout << "ERROR - MAT-file variable is missing values" << endl;
+        file.out.close();
+        return 1;
+    }
+    file.out.close();
+
+    // Return
+    return file.out.fail() ? 1 : 0;
+}
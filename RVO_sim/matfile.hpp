@@ -0,0 +1,72 @@
+#ifndef __MATFILE_H_INCLUDED__
+#define __MATFILE_H_INCLUDED__
+
+#include <fstream>
+#include <string>
+#include <stdint.h>
+
+using namespace std;
+
+/* MATLAB Level 5 .mat file being written
+ *  Variables are real double matrices. Each one is started with its size and
+ *  name, then its values are streamed in column-major order in as many pieces
+ *  as convenient, so the whole matrix never has to be held in memory.
+ *      ofstream out            - file being written
+ *      uint64_t remaining      - values still expected for the current variable
+ */
+struct MatFile {
+    ofstream out;
+    uint64_t remaining;
+};
+
+
+/* Function to create a .mat file and write its header
+ *  Input(s):
+ *      string filename     - file to be written
+ *  Output(s):
+ *      MatFile& file       - opened file
+ *      int                 - 0 if successful, 1 if failed
+ */
+int openMatFile(string filename,
+                MatFile& file);
+
+
+/* Function to start a double matrix variable
+ *  Input(s):
+ *      MatFile& file       - opened file, with no variable in progress
+ *      string name         - name of the variable in MATLAB
+ *      size_t rows, cols   - size of the matrix
+ *  Output(s):
+ *      int                 - 0 if successful, 1 if failed or too large for
+ *                            a Level 5 file
+ */
+int beginMatVariable(MatFile& file,
+                     string name,
+                     size_t rows,
+                     size_t cols);
+
+
+/* Function to append values to the current variable
+ *  Input(s):
+ *      MatFile& file       - opened file
+ *      double* values      - next values in column-major order
+ *      size_t count        - number of values
+ *  Output(s):
+ *      int                 - 0 if successful, 1 if more values than the
+ *                            matrix holds or the write failed
+ */
+int writeMatValues(MatFile& file,
+                   const double* values,
+                   size_t count);
+
+
+/* Function to finish the .mat file
+ *  Input(s):
+ *      MatFile& file       - opened file
+ *  Output(s):
+ *      int                 - 0 if successful, 1 if a variable is incomplete or
+ *                            the write failed
+ */
+int closeMatFile(MatFile& file);
+
+#endif  // __MATFILE_H_INCLUDED__
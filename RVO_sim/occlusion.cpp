@@ -0,0 +1,294 @@
+#include <cmath>
+#include <map>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "occlusion.hpp"
+
+
+/* Function to get the frame of a time
+ *  Input(s):
+ *      double t            - time (in seconds)
+ *      double timeStep     - time between frames (in seconds)
+ *  Output(s):
+ *      int64_t             - nearest frame number
+ */
+static int64_t getFrame(double t,
+                        double timeStep)
+{
+    return llround(t / timeStep);
+}
+
+
+/* Function to test whether an angle interval lies within one of a set of
+ * covered intervals
+ *  Input(s):
+ *      map<float,float> covered - disjoint intervals, start to end
+ *      float lo, hi        - interval
+ *  Output(s):
+ *      bool                - true if [lo, hi] is covered
+ */
+static bool isCovered(const map<float,float>& covered,
+                      float lo,
+                      float hi)
+{
+    map<float,float>::const_iterator it = covered.upper_bound(lo);
+    if (it == covered.begin()) {
+        return false;
+    }
+    --it;
+    return it->second >= hi;
+}
+
+
+/* Function to add an angle interval to a set of covered intervals, merging
+ * the intervals it touches
+ *  Input(s):
+ *      float lo, hi        - interval
+ *  Output(s):
+ *      map<float,float>& covered - updated disjoint intervals
+ */
+static void addCovered(map<float,float>& covered,
+                       float lo,
+                       float hi)
+{
+    map<float,float>::iterator it = covered.upper_bound(lo);
+    if (it != covered.begin()) {
+        map<float,float>::iterator prev = it;
+        --prev;
+        if (prev->second >= lo) {
+            lo = prev->first;
+            hi = max(hi, prev->second);
+            covered.erase(prev);
+        }
+    }
+    while (it != covered.end() && it->first <= hi) {
+        hi = max(hi, it->second);
+        covered.erase(it++);
+    }
+    covered[lo] = hi;
+}
+
+
+void getOccludedAgents(RVO::Vector2 center,
+                       const vector<RVO::Vector2>& positions,
+                       float radius,
+                       vector<bool>& occluded)
+{
+    size_t numAgents = positions.size();
+    occluded.assign(numAgents, false);
+    if (numAgents < 2) {
+        return;
+    }
+
+    // Sweep the agents from nearest to farthest
+    vector< pair<float,size_t> > order(numAgents);
+    for (size_t i = 0; i < numAgents; i++) {
+        order[i] = make_pair(absSq(positions[i] - center), i);
+    }
+    sort(order.begin(), order.end());
+
+    map<float,float> covered;
+    for (size_t k = 0; k < numAgents; k++) {
+        size_t i = order[k].second;
+        RVO::Vector2 offset = positions[i] - center;
+        float dist = sqrt(order[k].first);
+        float angle = atan2(offset.y(), offset.x());
+        float halfWidth = (dist > radius) ? asin(radius / dist) : (float) M_PI_2;
+
+        // Split the span where it wraps around at +-pi
+        float lo[2], hi[2];
+        int numPieces = 1;
+        lo[0] = angle - halfWidth;
+        hi[0] = angle + halfWidth;
+        if (lo[0] < -M_PI) {
+            lo[1] = lo[0] + 2*M_PI;
+            hi[1] = M_PI;
+            lo[0] = -M_PI;
+            numPieces = 2;
+        } else if (hi[0] > M_PI) {
+            lo[1] = -M_PI;
+            hi[1] = hi[0] - 2*M_PI;
+            hi[0] = M_PI;
+            numPieces = 2;
+        }
+
+        // Hidden if nearer agents cover the whole span, otherwise it covers
+        // its span for the farther ones
+        bool hidden = true;
+        for (int p = 0; p < numPieces; p++) {
+            hidden = hidden && isCovered(covered, lo[p], hi[p]);
+        }
+        if (hidden) {
+            occluded[i] = true;
+            continue;
+        }
+        for (int p = 0; p < numPieces; p++) {
+            addCovered(covered, lo[p], hi[p]);
+        }
+    }
+}
+
+
+void getOccludedPoints(RVO::RVOSimulator* sim,
+                       const vector< vector<RVO::Real> >& tracks,
+                       const CameraFOVs& fovs,
+                       const vector<CameraVisibility>& visibilities,
+                       float radius,
+                       double timeStep,
+                       vector< vector<uint64_t> >& occlusions)
+{
+    size_t numCams = fovs.numCameras;
+    occlusions.assign(tracks.size(), vector<uint64_t>());
+
+    // Frames spanned by each track
+    vector<int64_t> firstFrames(tracks.size()), endFrames(tracks.size());
+    int64_t minFrame = 0, endFrame = 0;
+    bool anyPoints = false;
+    for (size_t j = 0; j < tracks.size(); j++) {
+        size_t numPoints = tracks[j].size()/3-1;
+        if (numPoints == 0) {
+            firstFrames[j] = endFrames[j] = 0;
+            continue;
+        }
+        firstFrames[j] = getFrame(tracks[j][5], timeStep);
+        endFrames[j] = getFrame(tracks[j][3*numPoints + 2], timeStep) + 1;
+        minFrame = anyPoints ? min(minFrame, firstFrames[j]) : firstFrames[j];
+        endFrame = anyPoints ? max(endFrame, endFrames[j]) : endFrames[j];
+        anyPoints = true;
+    }
+    if (!anyPoints || numCams == 0) {
+        return;
+    }
+
+    // Split the frames into blocks processed in parallel
+    int numBlocks = 1;
+#ifdef _OPENMP
+    numBlocks = 4*omp_get_max_threads();
+#endif
+    vector< vector< pair<size_t,uint64_t> > > blockOcclusions(numBlocks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int b = 0; b < numBlocks; b++) {
+        int64_t f0 = minFrame + (endFrame - minFrame)*b/numBlocks;
+        int64_t f1 = minFrame + (endFrame - minFrame)*(b+1)/numBlocks;
+
+        // Tracks overlapping the block, in order of their first frame in it
+        vector< pair<int64_t,size_t> > starts;
+        for (size_t j = 0; j < tracks.size(); j++) {
+            if (firstFrames[j] < f1 && endFrames[j] > f0) {
+                starts.push_back(make_pair(max(firstFrames[j], f0), j));
+            }
+        }
+        sort(starts.begin(), starts.end());
+
+        vector<size_t> active, cursors;
+        vector<RVO::Real> coords;
+        vector<size_t> frameTracks, framePoints;
+        vector<size_t> pointCameras, cameras;
+        vector< vector<size_t> > camAgents(numCams);
+        vector<size_t> camsInFrame;
+        vector<RVO::Vector2> positions;
+        vector<bool> occluded;
+        size_t nextStart = 0;
+        for (int64_t f = f0; f < f1; f++) {
+            // Start the tracks reaching this frame, at their first point in the block
+            while (nextStart < starts.size() && starts[nextStart].first <= f) {
+                size_t j = starts[nextStart++].second;
+                const vector<RVO::Real>& track = tracks[j];
+                size_t lo = 0, hi = track.size()/3-1;
+                while (lo < hi) {
+                    size_t mid = (lo + hi)/2;
+                    if (getFrame(track[3*(mid+1) + 2], timeStep) < f) {
+                        lo = mid + 1;
+                    } else {
+                        hi = mid;
+                    }
+                }
+                active.push_back(j);
+                cursors.push_back(lo);
+            }
+
+            // Points of the active tracks in this frame, dropping finished tracks
+            coords.clear();
+            frameTracks.clear();
+            framePoints.clear();
+            for (size_t k = 0; k < active.size(); ) {
+                const vector<RVO::Real>& track = tracks[active[k]];
+                size_t numPoints = track.size()/3-1;
+                size_t& i = cursors[k];
+                while (i < numPoints && getFrame(track[3*(i+1) + 2], timeStep) < f) {
+                    i++;
+                }
+                if (i >= numPoints) {
+                    active[k] = active.back();
+                    cursors[k] = cursors.back();
+                    active.pop_back();
+                    cursors.pop_back();
+                    continue;
+                }
+                if (getFrame(track[3*(i+1) + 2], timeStep) == f) {
+                    coords.push_back(track[3*(i+1)]);
+                    coords.push_back(track[3*(i+1) + 1]);
+                    frameTracks.push_back(active[k]);
+                    framePoints.push_back(i);
+                }
+                k++;
+            }
+            if (frameTracks.size() < 2) {
+                continue;
+            }
+
+            // Agents seen by each camera
+            getCamerasContaining(fovs, &coords[0], 2, frameTracks.size(), pointCameras, cameras);
+            for (size_t p = 0; p < frameTracks.size(); p++) {
+                RVO::Vector2 pos = RVO::Vector2(coords[2*p], coords[2*p + 1]);
+                for (size_t k = pointCameras[p]; k < pointCameras[p+1]; k++) {
+                    size_t cam = cameras[k];
+                    if (!isVisibleFromCamera(sim, visibilities[cam], pos)) {
+                        continue;
+                    }
+                    if (camAgents[cam].empty()) {
+                        camsInFrame.push_back(cam);
+                    }
+                    camAgents[cam].push_back(p);
+                }
+            }
+
+            // Sweep each camera that sees more than one agent
+            for (size_t c = 0; c < camsInFrame.size(); c++) {
+                size_t cam = camsInFrame[c];
+                vector<size_t>& agents = camAgents[cam];
+                if (agents.size() >= 2) {
+                    positions.clear();
+                    for (size_t k = 0; k < agents.size(); k++) {
+                        positions.push_back(RVO::Vector2(coords[2*agents[k]], coords[2*agents[k] + 1]));
+                    }
+                    getOccludedAgents(visibilities[cam].center, positions, radius, occluded);
+                    for (size_t k = 0; k < agents.size(); k++) {
+                        if (occluded[k]) {
+                            blockOcclusions[b].push_back(make_pair(frameTracks[agents[k]],
+                                                                   framePoints[agents[k]]*numCams + cam));
+                        }
+                    }
+                }
+                agents.clear();
+            }
+            camsInFrame.clear();
+        }
+    }
+
+    // Gather the occluded points of each track
+    for (int b = 0; b < numBlocks; b++) {
+        for (size_t k = 0; k < blockOcclusions[b].size(); k++) {
+            occlusions[blockOcclusions[b][k].first].push_back(blockOcclusions[b][k].second);
+        }
+    }
+    for (size_t j = 0; j < occlusions.size(); j++) {
+        sort(occlusions[j].begin(), occlusions[j].end());
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef __OCCLUSION_H_INCLUDED__
+#define __OCCLUSION_H_INCLUDED__
+
+#include <vector>
+#include <stdint.h>
+#include "RVO.h"
+#include "camera.hpp"
+
+using namespace std;
+
+/* Occlusion of agents by other agents in camera views
+ *  In each frame, the agents a camera sees (inside its field of view and
+ *  line of sight) are swept from nearest to farthest. Each agent spans the
+ *  angles [a - asin(r/d), a + asin(r/d)] around the camera center, for its
+ *  direction a, distance d and radius r. An agent is occluded when nearer
+ *  agents of the frame cover all of its span, which a sorted set of the
+ *  covered angles answers in O(log k), for O(k log k) per camera and frame.
+ */
+
+
+/* Function to find the agents a camera cannot see behind nearer agents
+ *  Input(s):
+ *      RVO::Vector2 center   - camera center
+ *      vector<RVO::Vector2> positions - agents the camera sees in one frame
+ *      float radius          - agent radius
+ *  Output(s):
+ *      vector<bool>& occluded - whether each agent is covered by nearer ones
+ */
+void getOccludedAgents(RVO::Vector2 center,
+                       const vector<RVO::Vector2>& positions,
+                       float radius,
+                       vector<bool>& occluded);
+
+
+/* Function to find the occluded points of a set of tracks in all cameras
+ *  Points with the same time (to within half a time step) form a frame.
+ *  Blocks of frames are processed in parallel with OpenMP.
+ *  Input(s):
+ *      RVOSimulator* sim     - simulator with processed obstacles
+ *      vector<vector<RVO::Real>> tracks - ground truth tracks, each a row of
+ *                                         3 header values followed by x,y,t
+ *                                         triples (t in seconds, increasing)
+ *      CameraFOVs& fovs      - compiled fields of view
+ *      vector<CameraVisibility> visibilities - line of sight of each camera
+ *      float radius          - agent radius
+ *      double timeStep       - time between frames (in seconds)
+ *  Output(s):
+ *      vector<vector<uint64_t>>& occlusions - per track, the sorted keys
+ *                                             point*numCameras + camera of its
+ *                                             occluded points (point from 0)
+ */
+void getOccludedPoints(RVO::RVOSimulator* sim,
+                       const vector< vector<RVO::Real> >& tracks,
+                       const CameraFOVs& fovs,
+                       const vector<CameraVisibility>& visibilities,
+                       float radius,
+                       double timeStep,
+                       vector< vector<uint64_t> >& occlusions);
+
+#endif  // __OCCLUSION_H_INCLUDED__
@@ -516,11 +516,14 @@ int processEntranceProbabilities(vector<string> lines,
 /* Function to get locations of cameras in world coordinates
  *  Input(s):
  *      vector<string> lines    - vector of lines of coordinates read from file
+ *          Lines should be of the format: x,y,theta; optionally followed by
+ *          the field of view polygon in camera coords: (x0,y0);(x1,y1);...
  *  Output(s):
- *      int                             - 1 if successful, 0 if failed
- *      vector<vector<float>> cams - vector containing camera locations
+ *      int                             - 0 if successful, 1 if failed
+ *      vector<vector<float>> cams - vector containing camera locations, each
+ *                                   followed by its polygon vertices, if any
  *                                        (i.e. [[x0,y0,theta0],
- *                                               [x1,y1,theta1], ...
+ *                                               [x1,y1,theta1,px0,py0, ...], ...
  *                                              ]
  */
 int processCameraLocations(vector<string> lines,
@@ -529,8 +532,29 @@ int processCameraLocations(vector<string> lines,
     // Process each line of camera locations
     for (size_t i = 0; i < lines.size(); i++) {
         vector<float> singleCameraLocation;
+        // Split the location from the optional field of view polygon
+        size_t locationEnd = lines[i].find(';');
+        string location = lines[i];
+        string polygon;
+        if (locationEnd != string::npos) {
+            location = lines[i].substr(0,locationEnd+1);
+            polygon = lines[i].substr(locationEnd+1);
+        }
         // Convert line to floating point coordinates
-        if (!getCameraLocations(lines[i],singleCameraLocation)) {
+        if (!getCameraLocations(location,singleCameraLocation)) {
+            // Append the polygon vertices (in camera coords) after x,y,theta
+            if (polygon.find('(') != string::npos) {
+                vector< vector<float> > vertices;
+                if (getSceneDetails(polygon,vertices) || vertices.size() < 3) {
+                    cout << "ERROR - Invalid field of view in line '" << lines[i] << "'" << endl;
+                    cout << "Must have at least 3 vertices '(x,y);'" << endl;
+                    return 1;
+                }
+                for (size_t j = 0; j < vertices.size(); j++) {
+                    singleCameraLocation.push_back(vertices[j][0]);
+                    singleCameraLocation.push_back(vertices[j][1]);
+                }
+            }
             // Add these camera coordinates to the output
             cams.push_back(singleCameraLocation);
         }
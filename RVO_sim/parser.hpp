@@ -130,11 +130,14 @@ int processEntranceProbabilities(vector<string> lines,
 /* Function to get locations of cameras in world coordinates
  *  Input(s):
  *      vector<string> lines    - vector of lines of coordinates read from file
+ *          Lines should be of the format: x,y,theta; optionally followed by
+ *          the field of view polygon in camera coords: (x0,y0);(x1,y1);...
  *  Output(s):
- *      int                             - 1 if successful, 0 if failed
- *      vector<vector<float>> cams - vector containing camera locations
+ *      int                             - 0 if successful, 1 if failed
+ *      vector<vector<float>> cams - vector containing camera locations, each
+ *                                   followed by its polygon vertices, if any
  *                                        (i.e. [[x0,y0,theta0],
- *                                               [x1,y1,theta1], ...
+ *                                               [x1,y1,theta1,px0,py0, ...], ...
  *                                              ]
  */
 int processCameraLocations(vector<string> lines,
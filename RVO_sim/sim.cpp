@@ -3,9 +3,25 @@
 #include <fstream>
 #include <random>
 #include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "RVO.h"
 #include "parser.hpp"
+#include "flowfield.hpp"
+#include "camera.hpp"
+#include "trackfile.hpp"
+#include "matfile.hpp"
+#include "trackcodec.hpp"
+#include "layouts.hpp"
+#include "transitions.hpp"
+#include "heatmap.hpp"
+#include "livestats.hpp"
+#include "occlusion.hpp"
 
 #define _VERBOSE_ 0
 
@@ -22,19 +38,27 @@ vector< vector<RVO::Vector2> > goals;
 vector<bool> reachedPrimaryGoal;
 vector<bool> reachedSecondaryGoal;
 
+// Exit of each agent, and its primary and secondary exit lines by endpoints
+// goalLines = [[primary0_a0, primary1_a0, secondary0_a0, secondary1_a0], ...]
+vector<int> exitIndices;
+vector< vector<RVO::Vector2> > goalLines;
+
+// Navigation fields toward the secondary exit lines (empty unless -flow is given)
+FlowFields flowFields;
+
 // Store Tracklets in ground truth - Format: [camera number,track number, length of valid data, point0 ...]
 //  [[0,trk#,numPoints0,x(t00),y(t00),t00,x(t10),y(t10),t10, ... , x(tn0),y(tn0),tn0],
 //   [0,trk#,numPoints1,x(t01),y(t01),t01,x(t11),y(t11),t11, ... , x(tn1),y(tn1),tn1],
 //   ... ,
 //   [0,trk#,numPointsm,x(t0m),y(t0m),t0m,x(t1m),y(t1m),t1m, ... , x(tnm),y(tnm),tnm]]
-vector< vector<float> > groundTruthTracks;
+vector< vector<RVO::Real> > groundTruthTracks;
 
 // Store Tracklets by camera
 // [[[cam#,0,0,0],[x0,y0,t0,tr#],[x1,y1,t1,tr#], ... ],
 //  [[cam#,0,0,0],[x0,y0,t0,tr#],[x1,y1,t1,tr#], ... ],
 //  ... ,
 //  [[cam#,0,0,0],[x0,y0,t0,tr#],[x1,y1,t1,tr#], ... ]]
-vector< vector< vector<float> > > cameraTracks;
+vector< vector< vector<RVO::Real> > > cameraTracks;
 
 // Store Tracklet IDs by camera
 // [[id0cam0,id1cam0,...,idMcam0],
@@ -43,6 +67,15 @@ vector< vector< vector<float> > > cameraTracks;
 //  [id0camN,id1camN,...,idLcamN]]
 vector< vector<float> > cameraUniqueTracks;
 
+// Time resolution of the compact camera files (in ms, as in the camera tracks)
+const double TRACK_TIME_RESOLUTION = 0.001;
+
+// Time resolution of the saved ground truth (in seconds, as in groundTruthTracks)
+const double GROUND_TRUTH_TIME_RESOLUTION = 0.000001;
+
+// Camera State of each Ground Truth Track, for the online transition statistics
+vector<TrackCameraState> trackCameraStates;
+
 // Create Random Number Gen
 default_random_engine generator;
 uniform_real_distribution<float> distribution(0.0,1.0);
@@ -79,16 +112,69 @@ void updateVisualization(RVO::RVOSimulator* sim);
 bool reachedGoal(RVO::RVOSimulator* sim);
 void setPreferredVelocities(RVO::RVOSimulator* sim,
                             int& numActiveAgents);
+RVO::Real getGoalDistSq(RVO::RVOSimulator* sim,
+                        size_t agentNo,
+                        int goalNo);
+RVO::Vector2 getGoalDirection(RVO::RVOSimulator* sim,
+                              size_t agentNo,
+                              int goalNo);
 
 // Get tracklets in camera coordinates
-int inCameraFOV(int camNum,
-                vector<float> camLocation,
-                vector<RVO::Vector2> camPolygon,
-                int trackNum);
-int getCameraTracklets(vector< vector<float> > cameraLocations);
+vector<RVO::Vector2> getCameraPolygon(vector<float> camLocation);
+void getCameraVisibilities(RVO::RVOSimulator* sim,
+                           vector< vector<float> > cameraLocations,
+                           vector<CameraVisibility>& visibilities);
+int getCameraTracklets(RVO::RVOSimulator* sim,
+                       vector< vector<float> > cameraLocations,
+                       const CameraFOVs& cameraFOVs,
+                       const vector< vector<uint64_t> >& occlusions);
 
 // Write Ground Truth and Camera Coordinate Tracklets to file
-int writeTracks(char* outFilename);
+int writeTracks(char* outFilename,
+                size_t trackChunkSize,
+                double trackResolution);
+int writeMatFile(char* outFilename,
+                 vector< vector<float> > cameraLocations);
+
+// Save and load Ground Truth, to replay it through other camera layouts
+int saveGroundTruth(char* outFilename,
+                    double resolution);
+int loadGroundTruth(string filename);
+
+// Accumulate transitions between cameras (one TransitionStats per thread)
+void updateTransitions(RVO::RVOSimulator* sim,
+                       const CameraFOVs& cameraFOVs,
+                       const vector<CameraVisibility>& visibilities,
+                       vector<TransitionStats>& threadTransitions);
+void replayTransitions(RVO::RVOSimulator* sim,
+                       const CameraFOVs& cameraFOVs,
+                       const vector<CameraVisibility>& visibilities,
+                       vector<TransitionStats>& threadTransitions);
+int writeTransitions(char* outFilename,
+                     const vector<TransitionStats>& threadTransitions);
+
+// Accumulate heatmaps of the agents (one HeatmapGrid per thread) per time window
+void updateHeatmaps(RVO::RVOSimulator* sim,
+                    char* outFilename,
+                    double windowLength,
+                    int& window,
+                    vector<HeatmapGrid>& threadHeatmaps);
+int writeHeatmaps(char* outFilename,
+                  double windowLength,
+                  int window,
+                  vector<HeatmapGrid>& threadHeatmaps);
+
+// Publish a snapshot of the active agents to live viewers
+void publishAgentPositions(RVO::RVOSimulator* sim,
+                           int numActiveAgents,
+                           LiveStats& live);
+
+// Score candidate camera layouts against the Ground Truth
+int evaluateCameraLayouts(RVO::RVOSimulator* sim,
+                          char* layoutsFilename,
+                          vector<LayoutScores>& scores);
+int writeLayoutScores(char* outFilename,
+                      const vector<LayoutScores>& scores);
 
 
 // Main Function
@@ -107,6 +193,76 @@ int main(int argc, char* argv[])
     // Create a new Simulator Instance
     RVO::RVOSimulator* sim = new RVO::RVOSimulator();
     
+    // Parse Options (following <SetupFilename> <OutputFileBase>)
+    float detailMargin = -1.0f;
+    float flowCellSize = 0.0f;
+    size_t trackChunkSize = 0;
+    bool writeMat = false;
+    double trackResolution = 0.0;
+    double truthResolution = 0.0;
+    string replayFilename;
+    char* layoutsFilename = NULL;
+    double transitionBinWidth = 0.0;
+    float heatmapCellSize = 0.0f;
+    double heatmapWindowLength = 0.0;
+    string liveName;
+    int livePositionSteps = 0;
+    bool occlusion = false;
+    for (int i = 3; i < argc; i++) {
+        string option = argv[i];
+        if (option == "-skin" && i+1 < argc) {
+            // Reuse neighbor lists until an agent moves more than half the skin
+            sim->setNeighborSkin(atof(argv[++i]));
+        } else if (option == "-lod" && i+1 < argc) {
+            // Simulate agents farther than the margin from all cameras cheaply
+            detailMargin = atof(argv[++i]);
+        } else if (option == "-flow" && i+1 < argc) {
+            // Steer agents along navigation fields with cells of this size
+            flowCellSize = atof(argv[++i]);
+        } else if (option == "-trk" && i+1 < argc) {
+            // Also write chunked binary camera files with this many points per chunk
+            trackChunkSize = atoi(argv[++i]);
+        } else if (option == "-trc" && i+1 < argc) {
+            // Also write compact camera files with positions rounded to this many meters
+            trackResolution = atof(argv[++i]);
+        } else if (option == "-truth" && i+1 < argc) {
+            // Also save the ground truth with positions rounded to this many meters
+            truthResolution = atof(argv[++i]);
+        } else if (option == "-replay" && i+1 < argc) {
+            // Read the ground truth saved by -truth instead of simulating
+            replayFilename = argv[++i];
+        } else if (option == "-transitions" && i+1 < argc) {
+            // Also track transitions between cameras, with histogram bins of this many seconds
+            transitionBinWidth = atof(argv[++i]);
+        } else if (option == "-heatmap" && i+2 < argc) {
+            // Also bin agents on a grid with cells of this size, per window of this many seconds
+            heatmapCellSize = atof(argv[++i]);
+            heatmapWindowLength = atof(argv[++i]);
+        } else if (option == "-live" && i+1 < argc) {
+            // Publish live statistics to shared memory with this name
+            liveName = argv[++i];
+        } else if (option == "-livepos" && i+1 < argc) {
+            // Also publish agent positions every this many steps
+            livePositionSteps = atoi(argv[++i]);
+        } else if (option == "-occlusion") {
+            // Hide agents from cameras behind nearer agents
+            occlusion = true;
+        } else if (option == "-layouts" && i+1 < argc) {
+            // Also score the camera layouts in this file against the ground truth
+            layoutsFilename = argv[++i];
+        } else if (option == "-mat") {
+            // Also write all camera tracks to a MATLAB file
+            writeMat = true;
+        } else {
+            cout << "ERROR - Unknown option " << option << endl;
+            return 1;
+        }
+    }
+    if (livePositionSteps > 0 && liveName.empty()) {
+        cout << "ERROR - Option -livepos needs -live" << endl;
+        return 1;
+    }
+    
     // Parse File
     vector< vector<string> > sections;
     if (parseFile(filename, sections)) {
@@ -131,45 +287,68 @@ int main(int argc, char* argv[])
         cout << "Unable to setup scenario" << endl;
         return 1;
     }
-   
-    // Time Constant 
-    float prevTime = 0.0f;
-
-    // Simulate
-    do {
-        // Print Global Time every minute
-        if (sim->getGlobalTime() > prevTime + 120.0f) {
-	    prevTime = sim->getGlobalTime() - fmod(sim->getGlobalTime(),60.0f);
-            cout << "Simulation Time: " << sim->getGlobalTime()/60.0f << " min" << endl;
+    
+    // Navigation fields toward the exits, cached next to the setup file
+    if (flowCellSize > 0.0f) {
+        float radius = 0.0f;
+        getSimAgentLineDetails(sections[1][0], radius);
+        vector< vector<RVO::Vector2> > exits;
+        for (size_t i = 0; i < entrances.size(); i++) {
+            vector<RVO::Vector2> exit;
+            exit.push_back(entrances[i][4]);
+            exit.push_back(entrances[i][5]);
+            exits.push_back(exit);
         }
-	
-        // Add Agents (if necessary)
-        if (_VERBOSE_)
-            cout << "Update Agents" << endl;
-        updateAgents(sim,
-                     maxNumActiveAgents,
-                     numActiveAgents,
-                     entrances,
-                     transitionProbs);
-        // Record Agent Locations
-        if (_VERBOSE_)
-            cout << "Update Visualization" << endl;
-        updateVisualization(sim);
-        // Set Agent Preferred Velocities
-        if (_VERBOSE_)
-            cout << "Update Velocities" << endl;
-        setPreferredVelocities(sim,numActiveAgents);
-        // Simulate
-        if (_VERBOSE_)
-            cout << "Simulate" << endl;
-        sim->doStep();
-        if (_VERBOSE_)
-            cout << endl;
-    } while (!(sim->getGlobalTime() > lengthOfSim)); //(reachedGoal(sim) ||
+        string flowFilename = string(filename) + ".flow";
+        uint64_t key = getFlowFieldKey(sim, exits, flowCellSize, radius);
+        if (loadFlowFields(flowFilename, key, flowFields)) {
+            cout << "Computing flow fields" << endl;
+            if (computeFlowFields(sim, exits, flowCellSize, radius, flowFields)) {
+                cout << "Unable to compute flow fields" << endl;
+                return 1;
+            }
+            if (saveFlowFields(flowFilename, key, flowFields)) {
+                cout << "ERROR - Unable to cache flow fields to " << flowFilename << endl;
+            }
+        } else {
+            cout << "Loaded flow fields from " << flowFilename << endl;
+        }
+    }
     
-    // Put into Camera Coordinates
-    int tmp = getCameraTracklets(cameraLocations);
-     
+    // Compile the camera fields of view
+    CameraFOVs cameraFOVs;
+    vector< vector<RVO::Vector2> > cameraPolygons;
+    for (size_t i = 0; i < cameraLocations.size(); i++) {
+        cameraPolygons.push_back(getCameraPolygon(cameraLocations[i]));
+    }
+    if (compileCameraFOVs(cameraPolygons, cameraFOVs)) {
+        cout << "Unable to setup cameras" << endl;
+        return 1;
+    }
+    
+    // Full ORCA only near the camera fields of view
+    if (detailMargin >= 0.0f) {
+        for (size_t i = 0; i < cameraLocations.size(); i++) {
+            sim->addDetailRegion(cameraPolygons[i]);
+        }
+        sim->setDetailMargin(detailMargin);
+    }
+    
+    // Transitions between cameras, accumulated per thread while simulating
+    vector<CameraVisibility> cameraVisibilities;
+    vector<TransitionStats> threadTransitions;
+    if (transitionBinWidth > 0.0) {
+        getCameraVisibilities(sim, cameraLocations, cameraVisibilities);
+        int numThreads = 1;
+#ifdef _OPENMP
+        numThreads = omp_get_max_threads();
+#endif
+        threadTransitions.resize(numThreads);
+        for (int i = 0; i < numThreads; i++) {
+            initTransitionStats(cameraLocations.size(), transitionBinWidth, threadTransitions[i]);
+        }
+    }
+   
     // Load Output Filename
     char* outFilename;
     if (argc < 3) {
@@ -180,8 +359,141 @@ int main(int argc, char* argv[])
         cout << "Writing to " << outFilename << endl;
     }
      
+    // Heatmaps of the agents, accumulated per thread while simulating
+    vector<HeatmapGrid> threadHeatmaps;
+    int heatmapWindow = 0;
+    if (heatmapCellSize > 0.0f || heatmapWindowLength > 0.0) {
+        HeatmapGrid heatmap;
+        if (initHeatmap(sim, entrances, heatmapCellSize, heatmap) || !(heatmapWindowLength > 0.0)) {
+            cout << "Unable to setup heatmaps" << endl;
+            return 1;
+        }
+        int numThreads = 1;
+#ifdef _OPENMP
+        numThreads = omp_get_max_threads();
+#endif
+        threadHeatmaps.assign(numThreads, heatmap);
+    }
+   
+    if (!replayFilename.empty()) {
+        // Replay saved Ground Truth
+        cout << "Replaying ground truth from " << replayFilename << endl;
+        if (loadGroundTruth(replayFilename)) {
+            cout << "Unable to load ground truth from " << replayFilename << endl;
+            return 1;
+        }
+        if (transitionBinWidth > 0.0) {
+            replayTransitions(sim, cameraFOVs, cameraVisibilities, threadTransitions);
+        }
+        if (!threadHeatmaps.empty()) {
+            cout << "Heatmaps are only accumulated while simulating" << endl;
+        }
+    } else {
+        // Time Constant 
+        float prevTime = 0.0f;
+        
+        // Live Statistics for external viewers
+        LiveStats live;
+        initLiveStats(live);
+        if (!liveName.empty() && openLiveStats(liveName, live)) {
+            cout << "Unable to publish live statistics" << endl;
+            return 1;
+        }
+        uint64_t step = 0;
+
+        // Simulate
+        do {
+            // Print Global Time every minute
+            if (sim->getGlobalTime() > prevTime + 120.0f) {
+                prevTime = sim->getGlobalTime() - fmod(sim->getGlobalTime(),60.0f);
+                cout << "Simulation Time: " << sim->getGlobalTime()/60.0f << " min" << endl;
+            }
+	
+            // Add Agents (if necessary)
+            if (_VERBOSE_)
+                cout << "Update Agents" << endl;
+            updateAgents(sim,
+                         maxNumActiveAgents,
+                         numActiveAgents,
+                         entrances,
+                         transitionProbs);
+            markLivePhase(live, LIVE_PHASE_AGENTS);
+            // Record Agent Locations
+            if (_VERBOSE_)
+                cout << "Update Visualization" << endl;
+            updateVisualization(sim);
+            // Follow Agents between Cameras
+            if (transitionBinWidth > 0.0) {
+                updateTransitions(sim, cameraFOVs, cameraVisibilities, threadTransitions);
+            }
+            // Bin Agents into Heatmaps
+            if (!threadHeatmaps.empty()) {
+                updateHeatmaps(sim, outFilename, heatmapWindowLength, heatmapWindow, threadHeatmaps);
+            }
+            markLivePhase(live, LIVE_PHASE_RECORD);
+            // Set Agent Preferred Velocities
+            if (_VERBOSE_)
+                cout << "Update Velocities" << endl;
+            setPreferredVelocities(sim,numActiveAgents);
+            markLivePhase(live, LIVE_PHASE_VELOCITIES);
+            // Simulate
+            if (_VERBOSE_)
+                cout << "Simulate" << endl;
+            sim->doStep();
+            if (_VERBOSE_)
+                cout << endl;
+            markLivePhase(live, LIVE_PHASE_STEP);
+            // Publish Live Statistics
+            step++;
+            endLiveStep(live, step, sim->getGlobalTime(), numActiveAgents, sim->getNumAgents());
+            if (livePositionSteps > 0 && step % livePositionSteps == 0) {
+                publishAgentPositions(sim, numActiveAgents, live);
+            }
+        } while (!(sim->getGlobalTime() > lengthOfSim)); //(reachedGoal(sim) ||
+        
+        closeLiveStats(live);
+        
+        // Write the last Heatmap window, unless it only holds the sample at the end time
+        if (!threadHeatmaps.empty() && heatmapWindow * heatmapWindowLength < lengthOfSim) {
+            writeHeatmaps(outFilename, heatmapWindowLength, heatmapWindow, threadHeatmaps);
+        }
+    }
+    
+    // Find the points hidden behind other agents, per camera and frame
+    vector< vector<uint64_t> > occlusions;
+    if (occlusion) {
+        float radius = 0.0f;
+        getSimAgentLineDetails(sections[1][0], radius);
+        vector<CameraVisibility> visibilities;
+        getCameraVisibilities(sim, cameraLocations, visibilities);
+        getOccludedPoints(sim, groundTruthTracks, cameraFOVs, visibilities,
+                          radius, sim->getTimeStep(), occlusions);
+    }
+    
+    // Put into Camera Coordinates
+    int tmp = getCameraTracklets(sim, cameraLocations, cameraFOVs, occlusions);
+     
+    // Score Camera Layouts
+    vector<LayoutScores> layoutScores;
+    if (layoutsFilename != NULL) {
+        if (evaluateCameraLayouts(sim, layoutsFilename, layoutScores)) {
+            cout << "Unable to evaluate camera layouts from " << layoutsFilename << endl;
+            return 1;
+        }
+        tmp = writeLayoutScores(outFilename, layoutScores);
+    }
+    
     // Write Tracks to Files
-    tmp = writeTracks(outFilename);
+    if (transitionBinWidth > 0.0) {
+        tmp = writeTransitions(outFilename, threadTransitions);
+    }
+    if (truthResolution > 0.0) {
+        tmp = saveGroundTruth(outFilename, truthResolution);
+    }
+    tmp = writeTracks(outFilename, trackChunkSize, trackResolution);
+    if (writeMat) {
+        tmp = writeMatFile(outFilename, cameraLocations);
+    }
     
     // Track Stats
     cout << "Total Num Tracks: " << groundTruthTracks.size() << endl;
@@ -486,12 +798,19 @@ void updateAgents(RVO::RVOSimulator* sim,
         exits.push_back(primaryExitLoc);
         exits.push_back(secondaryExitLoc);
         goals.push_back(exits);
+        exitIndices.push_back(exitIndex);
+        vector<RVO::Vector2> lines;
+        lines.push_back(entrances[exitIndex][2]);
+        lines.push_back(entrances[exitIndex][3]);
+        lines.push_back(entrances[exitIndex][4]);
+        lines.push_back(entrances[exitIndex][5]);
+        goalLines.push_back(lines);
         // Initialize Agent's reachedPrimaryGoal, reachedSecondaryGoal
         reachedPrimaryGoal.push_back(false);
         reachedSecondaryGoal.push_back(false);
         // Initialize Agent's track with camera index (0 for now),
         // track index, and length of valid data (0 for now)
-        vector<float> track;
+        vector<RVO::Real> track;
         track.push_back(0);
         track.push_back(groundTruthTracks.size());
         track.push_back(0);
@@ -566,6 +885,45 @@ bool reachedGoal(RVO::RVOSimulator* sim)
 }
 
 
+RVO::Real getGoalDistSq(RVO::RVOSimulator* sim,
+                        size_t agentNo,
+                        int goalNo)
+{
+    // Walking distance left to the primary line when steering along flow fields,
+    // since the shortest paths cut the corners next to the line
+    if (!flowFields.distances.empty() && goalNo == 0) {
+        float distance = getFlowDistance(flowFields, exitIndices[agentNo], sim->getAgentPosition(agentNo));
+        float lineDistance = getFlowDistance(flowFields, exitIndices[agentNo],
+                                             0.5f*(goalLines[agentNo][0] + goalLines[agentNo][1]));
+        if (distance >= 0.0f && lineDistance >= 0.0f) {
+            return distance > lineDistance ? (distance - lineDistance)*(distance - lineDistance) : 0.0f;
+        }
+        return distSqPointSegment(goalLines[agentNo][0], goalLines[agentNo][1],
+                                  sim->getAgentPosition(agentNo));
+    }
+    return absSq(goals[agentNo][goalNo] - sim->getAgentPosition(agentNo));
+}
+
+
+RVO::Vector2 getGoalDirection(RVO::RVOSimulator* sim,
+                              size_t agentNo,
+                              int goalNo)
+{
+    // Follow the flow field toward the agent's exit until the agent is within
+    // parking distance (40 radii) of the exit line, then head for its own goal
+    // point so that parked agents spread out as before
+    if (!flowFields.distances.empty()) {
+        float distance = getFlowDistance(flowFields, exitIndices[agentNo], sim->getAgentPosition(agentNo));
+        RVO::Vector2 direction = getFlowDirection(flowFields, exitIndices[agentNo],
+                                                  sim->getAgentPosition(agentNo));
+        if (absSq(direction) > 0.0f && (goalNo == 0 || distance > 40*sim->getAgentRadius(agentNo))) {
+            return direction;
+        }
+    }
+    return normalize(goals[agentNo][goalNo] - sim->getAgentPosition(agentNo));
+}
+
+
 void setPreferredVelocities(RVO::RVOSimulator* sim,
                             int& numActiveAgents)
 {
@@ -573,7 +931,7 @@ void setPreferredVelocities(RVO::RVOSimulator* sim,
     for (size_t i = 0; i < sim->getNumAgents(); i++) {
         if (reachedPrimaryGoal[i]) {
             // Agent has passed primary goal -> Headed to secondary goal
-            if (absSq(goals[i][1] - sim->getAgentPosition(i)) < (sim->getTimeStep() * sim->getAgentMaxSpeed(i)) * (sim->getTimeStep() * sim->getAgentMaxSpeed(i)) + (1600*sim->getAgentRadius(i)*sim->getAgentRadius(i))) {
+            if (getGoalDistSq(sim,i,1) < (sim->getTimeStep() * sim->getAgentMaxSpeed(i)) * (sim->getTimeStep() * sim->getAgentMaxSpeed(i)) + (1600*sim->getAgentRadius(i)*sim->getAgentRadius(i))) {
                 //Agent is within (max speed * timestep + 40*agent_radius) of its secondary goal, set preferred velocity to 0
                 sim->setAgentPrefVelocity(i, RVO::Vector2(0.0f, 0.0f));
                 // First time at goal, reduce number of active agents, and set reachedSecondaryGoal to TRUE
@@ -585,14 +943,16 @@ void setPreferredVelocities(RVO::RVOSimulator* sim,
                     }
                     //***********************************************************************************
                     reachedSecondaryGoal[i] = true;
+                    // Parked agents never move again; keep them out of the step loop
+                    sim->setAgentDormant(i, true);
                 }
             } else {
                 // Agent is far away from its goal, set preferred velocity as unit vector times max speed towards agent's goal
-                sim->setAgentPrefVelocity(i, sim->getAgentMaxSpeed(i)*normalize(goals[i][1] - sim->getAgentPosition(i)));
+                sim->setAgentPrefVelocity(i, sim->getAgentMaxSpeed(i)*getGoalDirection(sim,i,1));
             }
         } else {
             // Agent has not passed primary goal -> Headed to primary goal
-            if (absSq(goals[i][0] - sim->getAgentPosition(i)) < (sim->getTimeStep() * sim->getAgentMaxSpeed(i)) * (sim->getTimeStep() * sim->getAgentMaxSpeed(i)) + (4*sim->getAgentRadius(i)*sim->getAgentRadius(i))) {
+            if (getGoalDistSq(sim,i,0) < (sim->getTimeStep() * sim->getAgentMaxSpeed(i)) * (sim->getTimeStep() * sim->getAgentMaxSpeed(i)) + (4*sim->getAgentRadius(i)*sim->getAgentRadius(i))) {
                 //Agent is within (max speed * timestep + 2*agent_radius) of its primary goal, head to secondary goal
                 reachedPrimaryGoal[i] = true;
                 //***************CHANGED TO INCREASE THE FREQUENCY OF AGENTS*************************
@@ -601,150 +961,187 @@ void setPreferredVelocities(RVO::RVOSimulator* sim,
                     cout << "Agent " << i << " reached Primary Goal" << endl;
                 }
                 //***********************************************************************************
-                sim->setAgentPrefVelocity(i, sim->getAgentMaxSpeed(i)*normalize(goals[i][1] - sim->getAgentPosition(i)));
+                sim->setAgentPrefVelocity(i, sim->getAgentMaxSpeed(i)*getGoalDirection(sim,i,1));
             } else {
                 // Agent is far away from its goal, set preferred velocity as unit vector times max speed towards agent's goal
-                sim->setAgentPrefVelocity(i, sim->getAgentMaxSpeed(i)*normalize(goals[i][0] - sim->getAgentPosition(i)));
+                sim->setAgentPrefVelocity(i, sim->getAgentMaxSpeed(i)*getGoalDirection(sim,i,0));
             }
         }
     }
 }
 
 
-int inCameraFOV(int camNum,
-                vector<float> camLocation,
-                vector<RVO::Vector2> camPolygon,
-                int trackNum)
+vector<RVO::Vector2> getCameraPolygon(vector<float> camLocation)
 {
-    // Get Camera Location
+    // Camera Field of View (centered at x=0,y=0,theta=0), from the scene file
+    // if given after x,y,theta
+    vector<RVO::Vector2> camPolygon;
+    if (camLocation.size() > 3) {
+        for (size_t j = 3; j+1 < camLocation.size(); j += 2) {
+            camPolygon.push_back(RVO::Vector2(camLocation[j],camLocation[j+1]));
+        }
+    } else {
+        camPolygon.push_back(RVO::Vector2(9.0f,1.0f));
+        camPolygon.push_back(RVO::Vector2(17.5f,5.5f));
+        camPolygon.push_back(RVO::Vector2(17.5f,-5.5f));
+        camPolygon.push_back(RVO::Vector2(9.0f,-1.0f));
+    }
+    
+    // Determine Camera's Vertices
     float x0 = camLocation[0];
     float y0 = camLocation[1];
     RVO::Vector2 camCenter = RVO::Vector2(x0,y0);
     float theta = M_PI*camLocation[2]/180;
-    vector<RVO::Vector2> inv_rotation;
-    inv_rotation.push_back(RVO::Vector2(cos(-theta),-sin(-theta)));
-    inv_rotation.push_back(RVO::Vector2(sin(-theta),cos(-theta)));
-    
-    // Capture Track Information
-    float trackID = groundTruthTracks[trackNum][1];
-    
-    // Keep track of whether tracklet is in this camera
-    size_t trackletInCam = 0;
-    
-    // Find all points in this track which fall in this camera's FOV
-    for (size_t i = 0; i < groundTruthTracks[trackNum].size()/3-1; i++) {
-        // Get Point
-        float x = groundTruthTracks[trackNum][3*(i+1)];
-        float y = groundTruthTracks[trackNum][3*(i+1) + 1];
-        RVO::Vector2 p = RVO::Vector2(x,y);
-        float t = groundTruthTracks[trackNum][3*(i+1) + 2];
+    vector<RVO::Vector2> rotation;
+    rotation.push_back(RVO::Vector2(cos(theta),-sin(theta)));
+    rotation.push_back(RVO::Vector2(sin(theta),cos(theta)));
+    vector<RVO::Vector2> camPolygonRot;
+    for (size_t j = 0; j < camPolygon.size(); j++) {
+        camPolygonRot.push_back(RVO::Vector2(rotation[0]*camPolygon[j],
+                                             rotation[1]*camPolygon[j]) +
+                                camCenter);
+        //        cout << camPolygonRot[j].x() << " " << camPolygonRot[j].y() << endl;
+    }
+    
+    // Return
+    return camPolygonRot;
+}
+
+
+void getCameraVisibilities(RVO::RVOSimulator* sim,
+                           vector< vector<float> > cameraLocations,
+                           vector<CameraVisibility>& visibilities)
+{
+    visibilities.resize(cameraLocations.size());
+    for (size_t i = 0; i < cameraLocations.size(); i++) {
+        // Determine Camera's Vertices
+        vector<RVO::Vector2> camPolygonRot = getCameraPolygon(cameraLocations[i]);
         
-        // Check if Point is within polygon
-        size_t validSignFlag = 1;
-        float prevResult= 0;
-        for (size_t j = 0; j < camPolygon.size(); j++) {
-            // Get Vertices defining line segment
-            RVO::Vector2 A = camPolygon[j];
-            RVO::Vector2 B;
-            if (j+1 == camPolygon.size()) {
-                B = camPolygon[0];
-            } else {
-                B = camPolygon[j+1];
+        // Determine the region in the camera's line of sight
+        RVO::Vector2 camCenter = RVO::Vector2(cameraLocations[i][0],cameraLocations[i][1]);
+        float range = 0.0f;
+        for (size_t j = 0; j < camPolygonRot.size(); j++) {
+            float dist = abs(camPolygonRot[j] - camCenter);
+            if (dist > range) {
+                range = dist;
             }
-            RVO::Vector2 perp = RVO::Vector2(-(B.y()-A.y()),(B.x()-A.x()));
-            
-            // Check Sign
-            float result = perp*(p-A);
-            // First Run through => capture result
-            if (prevResult == 0) {
-                prevResult = result;
-                // Move to next segment if sign is same
-            } else if (prevResult*result > 0) {
-                prevResult = result;
-                // Skip if point is on this line
-            } else if (result == 0) {
-                continue;
-                // Sign is different => Point not in polygon
-            } else {
-                validSignFlag = 0;
-                break;
-            }
-        }
-        
-        // Capture Point if in polygon
-        if (validSignFlag) {
-            // Update status of the tracklet occuring in this camera
-            trackletInCam = 1;
-            
-            // Convert groundTrack point to camera frame
-            RVO::Vector2 p_cam = RVO::Vector2(inv_rotation[0]*(p-camCenter),
-                                              inv_rotation[1]*(p-camCenter));
-            // Add Point
-            vector<float> point;
-            point.push_back(p_cam.x());
-            point.push_back(p_cam.y());
-            point.push_back(t*1000);
-            point.push_back(trackID);
-            // Add to cameraTracks
-            cameraTracks[camNum].push_back(point);
         }
+        computeCameraVisibility(sim, camCenter, range, visibilities[i]);
     }
-    
-    // Add tracklet ID to cameraUniqueTracks
-    if (trackletInCam) {
-        cameraUniqueTracks[camNum].push_back(trackNum);
-    }
-    
-    // Return
-    return 0;
 }
 
 
-int getCameraTracklets(vector< vector<float> > cameraLocations)
+int getCameraTracklets(RVO::RVOSimulator* sim,
+                       vector< vector<float> > cameraLocations,
+                       const CameraFOVs& cameraFOVs,
+                       const vector< vector<uint64_t> >& occlusions)
 {
-    // Camera Field of View (centered at x=0,y=0,theta=0)
-    vector<RVO::Vector2> camPolygon;
-    camPolygon.push_back(RVO::Vector2(9.0f,1.0f));
-    camPolygon.push_back(RVO::Vector2(17.5f,5.5f));
-    camPolygon.push_back(RVO::Vector2(17.5f,-5.5f));
-    camPolygon.push_back(RVO::Vector2(9.0f,-1.0f));
-    
-    // Find tracklets contained in each camera's field of view
+    // Prepare each camera
+    vector<CameraVisibility> visibilities;
+    getCameraVisibilities(sim, cameraLocations, visibilities);
+    vector< vector<RVO::Vector2> > invRotations;
     for (size_t i = 0; i < cameraLocations.size(); i++) {
         // Initialize Camera in cameraTracks, cameraUniqueTracks
-        vector<float> firstRow;
+        vector<RVO::Real> firstRow;
         firstRow.push_back(i);  // Camera Number
-        vector< vector<float> > cameraTrack;
+        vector< vector<RVO::Real> > cameraTrack;
         cameraTrack.push_back(firstRow);
         cameraTracks.push_back(cameraTrack);
         vector<float> trackIDsInCam;
         cameraUniqueTracks.push_back(trackIDsInCam);
         
-        // Determine Camera's Vertices
-        float x0 = cameraLocations[i][0];
-        float y0 = cameraLocations[i][1];
-        RVO::Vector2 camCenter = RVO::Vector2(x0,y0);
+        // Rotation from world to camera frame
         float theta = M_PI*cameraLocations[i][2]/180;
-        vector<RVO::Vector2> rotation;
-        rotation.push_back(RVO::Vector2(cos(theta),-sin(theta)));
-        rotation.push_back(RVO::Vector2(sin(theta),cos(theta)));
-        vector<RVO::Vector2> camPolygonRot;
-        for (size_t j = 0; j < camPolygon.size(); j++) {
-            camPolygonRot.push_back(RVO::Vector2(rotation[0]*camPolygon[j],
-                                                 rotation[1]*camPolygon[j]) +
-                                    camCenter);
-            //            cout << camPolygonRot[j].x() << " " << camPolygonRot[j].y() << endl;
-        }
-        
-        // Loop through all tracks
-        for (size_t j = 0; j < groundTruthTracks.size(); j++) {
-            // Add all points in this track that are in this camera's FOV to cameraTracks
-            if (inCameraFOV(i,cameraLocations[i],camPolygonRot,j)) {
-                cout << "ERROR - Unable to determine camera tracklets for camera: " << i << ", track: " << j << endl;
+        vector<RVO::Vector2> inv_rotation;
+        inv_rotation.push_back(RVO::Vector2(cos(-theta),-sin(-theta)));
+        inv_rotation.push_back(RVO::Vector2(sin(-theta),cos(-theta)));
+        invRotations.push_back(inv_rotation);
+    }
+    
+    // Split the tracks into blocks processed in parallel; each block collects
+    // its own camera points, which are then appended in track order
+    int numBlocks = 1;
+#ifdef _OPENMP
+    numBlocks = 4*omp_get_max_threads();
+#endif
+    size_t numCams = cameraLocations.size();
+    vector< vector< vector< vector<RVO::Real> > > > blockTracks(numBlocks,
+        vector< vector< vector<RVO::Real> > >(numCams));
+    vector< vector< vector<float> > > blockUniqueTracks(numBlocks,
+        vector< vector<float> >(numCams));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int b = 0; b < numBlocks; b++) {
+        // Loop through the block's tracks, testing each point only against nearby cameras
+        vector<size_t> pointCameras;
+        vector<size_t> cameras;
+        vector<bool> trackletInCam(numCams, false);
+        vector<size_t> trackletCams;
+        size_t firstTrack = groundTruthTracks.size()*b/numBlocks;
+        size_t endTrack = groundTruthTracks.size()*(b+1)/numBlocks;
+        for (size_t j = firstTrack; j < endTrack; j++) {
+            const vector<RVO::Real>& track = groundTruthTracks[j];
+            RVO::Real trackID = track[1];
+            size_t numPoints = track.size()/3-1;
+            getCamerasContaining(cameraFOVs, &track[0] + 3, 3, numPoints, pointCameras, cameras);
+            
+            for (size_t i = 0; i < numPoints; i++) {
+                RVO::Vector2 p = RVO::Vector2(track[3*(i+1)], track[3*(i+1) + 1]);
+                RVO::Real t = track[3*(i+1) + 2];
+                
+                for (size_t k = pointCameras[i]; k < pointCameras[i+1]; k++) {
+                    // Capture Point if not hidden behind an obstacle
+                    size_t cam = cameras[k];
+                    if (!isVisibleFromCamera(sim, visibilities[cam], p)) {
+                        continue;
+                    }
+                    // or behind nearer agents
+                    if (!occlusions.empty() &&
+                        binary_search(occlusions[j].begin(), occlusions[j].end(), i*numCams + cam)) {
+                        continue;
+                    }
+                    // Keep track of the cameras this tracklet is in
+                    if (!trackletInCam[cam]) {
+                        trackletInCam[cam] = true;
+                        trackletCams.push_back(cam);
+                    }
+                    
+                    // Convert groundTrack point to camera frame
+                    RVO::Vector2 camCenter = RVO::Vector2(cameraLocations[cam][0],cameraLocations[cam][1]);
+                    RVO::Vector2 p_cam = RVO::Vector2(invRotations[cam][0]*(p-camCenter),
+                                                      invRotations[cam][1]*(p-camCenter));
+                    // Add Point
+                    vector<RVO::Real> point;
+                    point.push_back(p_cam.x());
+                    point.push_back(p_cam.y());
+                    point.push_back(t*1000);
+                    point.push_back(trackID);
+                    // Add to the block's camera tracks
+                    blockTracks[b][cam].push_back(point);
+                }
             }
             
+            // Add tracklet ID to the block's unique tracks
+            for (size_t k = 0; k < trackletCams.size(); k++) {
+                blockUniqueTracks[b][trackletCams[k]].push_back(j);
+                trackletInCam[trackletCams[k]] = false;
+            }
+            trackletCams.clear();
+        }
+    }
+    
+    // Append the blocks to cameraTracks, cameraUniqueTracks, in parallel across cameras
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int cam = 0; cam < static_cast<int>(numCams); cam++) {
+        for (int b = 0; b < numBlocks; b++) {
+            cameraTracks[cam].insert(cameraTracks[cam].end(),
+                                     blockTracks[b][cam].begin(), blockTracks[b][cam].end());
+            cameraUniqueTracks[cam].insert(cameraUniqueTracks[cam].end(),
+                                           blockUniqueTracks[b][cam].begin(), blockUniqueTracks[b][cam].end());
         }
-        
     }
     
     // Return
@@ -752,7 +1149,9 @@ int getCameraTracklets(vector< vector<float> > cameraLocations)
 }
 
 
-int writeTracks(char* outFilename)
+int writeTracks(char* outFilename,
+                size_t trackChunkSize,
+                double trackResolution)
 {
     // Find Max Vector Length
     size_t maxVectorLen = 0;
@@ -797,9 +1196,12 @@ int writeTracks(char* outFilename)
 //    // Close file
 //    groundOutFile.close();
     
-    // *** Write Camera files to <filename>_cam<cam_id>.csv ***
-    for (size_t i = 0; i < cameraTracks.size(); i++) {
-        vector< vector<float> > cameraTrack = cameraTracks[i];
+    // *** Write Camera files to <filename>_cam<cam_id>.csv, in parallel across cameras ***
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int i = 0; i < static_cast<int>(cameraTracks.size()); i++) {
+        const vector< vector<RVO::Real> >& cameraTrack = cameraTracks[i];
         // Open File
         ofstream camOutFile;
         string camOutFilenameString;
@@ -825,9 +1227,441 @@ int writeTracks(char* outFilename)
         // Close File
         camOutFile.close();
         
+        // Also write the chunked binary file <filename>_cam<cam_id>.trk
+        if (trackChunkSize > 0) {
+            string trackFilename = camOutFilenameString.substr(0, camOutFilenameString.size()-4) + ".trk";
+            writeTrackFile(trackFilename, cameraTrack, trackChunkSize);
+        }
+        
+        // Also write the compact encoding <filename>_cam<cam_id>.trc
+        if (trackResolution > 0.0) {
+            string codecFilename = camOutFilenameString.substr(0, camOutFilenameString.size()-4) + ".trc";
+            TrackEncoder encoder;
+            if (!openTrackEncoder(codecFilename, trackResolution, TRACK_TIME_RESOLUTION, encoder)) {
+                for (size_t pointInd = 1; pointInd < cameraTrack.size(); pointInd++) {
+                    encodeTrackPoint(encoder,
+                                     (uint64_t) cameraTrack[pointInd][3],
+                                     cameraTrack[pointInd][0],
+                                     cameraTrack[pointInd][1],
+                                     cameraTrack[pointInd][2]);
+                }
+                if (closeTrackEncoder(encoder)) {
+                    cout << "ERROR - Unable to write camera tracks to " << codecFilename << endl;
+                }
+            }
+        }
     }
     
     // Return
     return 0;
 }
 
+
+int writeMatFile(char* outFilename,
+                 vector< vector<float> > cameraLocations)
+{
+    // Write <filename>.mat
+    string matFilenameString;
+    matFilenameString.append("./data/");
+    matFilenameString.append(outFilename);
+    matFilenameString.append(".mat");
+    MatFile matFile;
+    if (openMatFile(matFilenameString, matFile)) {
+        return 1;
+    }
+    
+    // Camera poses: [x y theta] per camera, theta in radians
+    if (beginMatVariable(matFile, "camera_poses", cameraLocations.size(), 3)) {
+        return 1;
+    }
+    for (size_t col = 0; col < 3; col++) {
+        for (size_t i = 0; i < cameraLocations.size(); i++) {
+            double value = cameraLocations[i][col];
+            if (col == 2) {
+                value = M_PI*value/180;
+            }
+            writeMatValues(matFile, &value, 1);
+        }
+    }
+    
+    // Camera tracks: cam<cam_id> = [x y t tr#] per point, as in the .csv files,
+    // streamed a column at a time through a small buffer
+    vector<double> buffer(4096);
+    for (size_t i = 0; i < cameraTracks.size(); i++) {
+        const vector< vector<RVO::Real> >& cameraTrack = cameraTracks[i];
+        size_t numPoints = cameraTrack.size() - 1;
+        string name = "cam" + to_string((int) cameraTrack[0][0]);
+        if (beginMatVariable(matFile, name, numPoints, 4)) {
+            return 1;
+        }
+        for (size_t col = 0; col < 4; col++) {
+            for (size_t first = 0; first < numPoints; first += buffer.size()) {
+                size_t count = min(buffer.size(), numPoints - first);
+                for (size_t j = 0; j < count; j++) {
+                    buffer[j] = cameraTrack[first + j + 1][col];
+                }
+                writeMatValues(matFile, &buffer[0], count);
+            }
+        }
+    }
+    
+    // Close File
+    if (closeMatFile(matFile)) {
+        cout << "ERROR - Unable to write MAT-file " << matFilenameString << endl;
+        return 1;
+    }
+    
+    // Return
+    return 0;
+}
+
+
+int saveGroundTruth(char* outFilename,
+                    double resolution)
+{
+    // Write ground truth to <filename>_truth.trc
+    string truthFilenameString;
+    truthFilenameString.append("./data/");
+    truthFilenameString.append(outFilename);
+    truthFilenameString.append("_truth.trc");
+    TrackEncoder encoder;
+    if (openTrackEncoder(truthFilenameString, resolution, GROUND_TRUTH_TIME_RESOLUTION, encoder)) {
+        return 1;
+    }
+    for (size_t i = 0; i < groundTruthTracks.size(); i++) {
+        const vector<RVO::Real>& track = groundTruthTracks[i];
+        for (size_t j = 0; j < track.size()/3-1; j++) {
+            encodeTrackPoint(encoder,
+                             (uint64_t) track[1],
+                             track[3*(j+1)],
+                             track[3*(j+1) + 1],
+                             track[3*(j+1) + 2]);
+        }
+    }
+    if (closeTrackEncoder(encoder)) {
+        cout << "ERROR - Unable to write ground truth to " << truthFilenameString << endl;
+        return 1;
+    }
+    
+    // Return
+    return 0;
+}
+
+
+int loadGroundTruth(string filename)
+{
+    TrackDecoder decoder;
+    if (openTrackDecoder(filename, decoder)) {
+        return 1;
+    }
+    
+    // Rebuild the tracks by track number (tracks without points stay empty)
+    uint64_t trackID;
+    double x, y, t;
+    groundTruthTracks.clear();
+    while (!decodeTrackPoint(decoder, trackID, x, y, t)) {
+        while (groundTruthTracks.size() <= trackID) {
+            vector<RVO::Real> track;
+            track.push_back(0);
+            track.push_back(groundTruthTracks.size());
+            track.push_back(0);
+            groundTruthTracks.push_back(track);
+        }
+        vector<RVO::Real>& track = groundTruthTracks[trackID];
+        track.push_back(x);
+        track.push_back(y);
+        track.push_back(t);
+        track[2] += 1;
+    }
+    
+    // Return
+    return 0;
+}
+
+
+int evaluateCameraLayouts(RVO::RVOSimulator* sim,
+                          char* layoutsFilename,
+                          vector<LayoutScores>& scores)
+{
+    // Each section of the file is one layout, with a camera per line as in
+    // the scene file
+    vector< vector<string> > sections;
+    if (parseFile(layoutsFilename, sections)) {
+        return 1;
+    }
+    vector< vector<RVO::Vector2> > centers(sections.size());
+    vector< vector< vector<RVO::Vector2> > > polygons(sections.size());
+    for (size_t l = 0; l < sections.size(); l++) {
+        vector< vector<float> > layoutLocations;
+        if (processCameraLocations(sections[l], layoutLocations) || layoutLocations.empty()) {
+            cout << "ERROR - Unable to process layout " << l << endl;
+            return 1;
+        }
+        for (size_t i = 0; i < layoutLocations.size(); i++) {
+            centers[l].push_back(RVO::Vector2(layoutLocations[i][0],layoutLocations[i][1]));
+            polygons[l].push_back(getCameraPolygon(layoutLocations[i]));
+        }
+    }
+    cout << "Evaluating " << sections.size() << " camera layouts" << endl;
+    
+    // Return
+    return evaluateLayouts(sim, groundTruthTracks, centers, polygons, scores);
+}
+
+
+int writeLayoutScores(char* outFilename,
+                      const vector<LayoutScores>& scores)
+{
+    // *** Write one row per layout to <filename>_layouts.csv ***
+    string layoutsFilename = string("./data/") + outFilename + "_layouts.csv";
+    ofstream layoutsFile(layoutsFilename.c_str(), ios::trunc);
+    if (!layoutsFile.is_open()) {
+        cout << "ERROR - Unable to write layout scores to " << layoutsFilename << endl;
+        return 1;
+    }
+    for (size_t l = 0; l < scores.size(); l++) {
+        const LayoutScores& s = scores[l];
+        layoutsFile << l << " "
+        << s.numCameras << " "
+        << (s.numPoints > 0 ? (double) s.coveredPoints / s.numPoints : 0.0) << " "
+        << (s.numPoints > 0 ? (double) s.overlapPoints / s.numPoints : 0.0) << " "
+        << s.coveredTracks << " "
+        << s.numTracklets << " "
+        << (s.numTracklets > 0 ? s.trackletTime / s.numTracklets : 0.0) << " "
+        << s.numTransitions << "\n";
+    }
+    layoutsFile.close();
+    
+    // *** Write the camera pairs that overlap or are transitioned between
+    // to <filename>_layout_pairs.csv ***
+    string pairsFilename = string("./data/") + outFilename + "_layout_pairs.csv";
+    ofstream pairsFile(pairsFilename.c_str(), ios::trunc);
+    if (!pairsFile.is_open()) {
+        cout << "ERROR - Unable to write layout scores to " << pairsFilename << endl;
+        return 1;
+    }
+    for (size_t l = 0; l < scores.size(); l++) {
+        const LayoutScores& s = scores[l];
+        size_t n = s.numCameras;
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = i+1; j < n; j++) {
+                if (s.pairOverlap[i*n + j] == 0 &&
+                    s.pairTransitions[i*n + j] == 0 &&
+                    s.pairTransitions[j*n + i] == 0) {
+                    continue;
+                }
+                pairsFile << l << " " << i << " " << j << " "
+                << s.pairOverlap[i*n + j] << " "
+                << s.pairTransitions[i*n + j] << " "
+                << s.pairTransitions[j*n + i] << "\n";
+            }
+        }
+    }
+    pairsFile.close();
+    
+    // Return
+    return 0;
+}
+
+
+/* Function to find the cameras seeing a point, as in getCameraTracklets
+ *  Input(s):
+ *      RVOSimulator* sim     - simulator with processed obstacles
+ *      CameraFOVs& cameraFOVs - compiled fields of view
+ *      vector<CameraVisibility> visibilities - line of sight of each camera
+ *      RVO::Vector2 p        - point
+ *  Output(s):
+ *      vector<size_t>& pointCameras, cameras - scratch space
+ *      vector<size_t>& cams  - cameras seeing p, in increasing order
+ */
+static void getCamerasSeeing(RVO::RVOSimulator* sim,
+                             const CameraFOVs& cameraFOVs,
+                             const vector<CameraVisibility>& visibilities,
+                             RVO::Vector2 p,
+                             vector<size_t>& pointCameras,
+                             vector<size_t>& cameras,
+                             vector<size_t>& cams)
+{
+    RVO::Real coords[2] = {p.x(), p.y()};
+    getCamerasContaining(cameraFOVs, coords, 2, 1, pointCameras, cameras);
+    cams.clear();
+    for (size_t k = 0; k < cameras.size(); k++) {
+        if (isVisibleFromCamera(sim, visibilities[cameras[k]], p)) {
+            cams.push_back(cameras[k]);
+        }
+    }
+}
+
+
+void updateTransitions(RVO::RVOSimulator* sim,
+                       const CameraFOVs& cameraFOVs,
+                       const vector<CameraVisibility>& visibilities,
+                       vector<TransitionStats>& threadTransitions)
+{
+    // New agents start out unseen
+    TrackCameraState unseen;
+    unseen.lastCam = -1;
+    unseen.lastTime = 0.0;
+    trackCameraStates.resize(sim->getNumAgents(), unseen);
+    double t = sim->getGlobalTime();
+    
+    // Advance the agents still recorded in groundTruthTracks, each thread
+    // adding to its own transitions
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        vector<size_t> pointCameras, cameras, cams;
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (int i = 0; i < static_cast<int>(sim->getNumAgents()); i++) {
+            if (reachedPrimaryGoal[i]) {
+                continue;
+            }
+            getCamerasSeeing(sim, cameraFOVs, visibilities, sim->getAgentPosition(i),
+                             pointCameras, cameras, cams);
+            updateTrackCameras(trackCameraStates[i], cams, t, threadTransitions[thread]);
+        }
+    }
+}
+
+
+void replayTransitions(RVO::RVOSimulator* sim,
+                       const CameraFOVs& cameraFOVs,
+                       const vector<CameraVisibility>& visibilities,
+                       vector<TransitionStats>& threadTransitions)
+{
+    TrackCameraState unseen;
+    unseen.lastCam = -1;
+    unseen.lastTime = 0.0;
+    trackCameraStates.assign(groundTruthTracks.size(), unseen);
+    
+    // Advance each loaded track through all its points
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        vector<size_t> pointCameras, cameras, cams;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (int i = 0; i < static_cast<int>(groundTruthTracks.size()); i++) {
+            const vector<RVO::Real>& track = groundTruthTracks[i];
+            for (size_t j = 1; j < track.size()/3; j++) {
+                RVO::Vector2 p = RVO::Vector2(track[3*j], track[3*j + 1]);
+                getCamerasSeeing(sim, cameraFOVs, visibilities, p, pointCameras, cameras, cams);
+                updateTrackCameras(trackCameraStates[i], cams, track[3*j + 2], threadTransitions[thread]);
+            }
+        }
+    }
+}
+
+
+int writeTransitions(char* outFilename,
+                     const vector<TransitionStats>& threadTransitions)
+{
+    // Sum the transitions of all threads
+    TransitionStats transitions = threadTransitions[0];
+    for (size_t i = 1; i < threadTransitions.size(); i++) {
+        mergeTransitionStats(threadTransitions[i], transitions);
+    }
+    
+    // *** Write to <filename>_transitions.csv ***
+    string transitionsFilename = string("./data/") + outFilename + "_transitions.csv";
+    
+    // Return
+    return writeTransitionStats(transitionsFilename, transitions);
+}
+
+
+void updateHeatmaps(RVO::RVOSimulator* sim,
+                    char* outFilename,
+                    double windowLength,
+                    int& window,
+                    vector<HeatmapGrid>& threadHeatmaps)
+{
+    // Write the previous window once the time has moved past it
+    int currentWindow = (int) floor(sim->getGlobalTime() / windowLength);
+    if (currentWindow != window) {
+        writeHeatmaps(outFilename, windowLength, window, threadHeatmaps);
+        window = currentWindow;
+    }
+    
+    // Add the agents still recorded in groundTruthTracks, each thread to its own grid
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+        for (int i = 0; i < static_cast<int>(sim->getNumAgents()); i++) {
+            if (reachedPrimaryGoal[i]) {
+                continue;
+            }
+            addHeatmapSample(threadHeatmaps[thread], sim->getAgentPosition(i),
+                             sim->getAgentVelocity(i));
+        }
+    }
+    threadHeatmaps[0].numSteps++;
+}
+
+
+int writeHeatmaps(char* outFilename,
+                  double windowLength,
+                  int window,
+                  vector<HeatmapGrid>& threadHeatmaps)
+{
+    // Sum the grids of all threads into the first
+    for (size_t i = 1; i < threadHeatmaps.size(); i++) {
+        mergeHeatmap(threadHeatmaps[i], threadHeatmaps[0]);
+    }
+    
+    // *** Write to <filename>_heat<window>.pgm and .heat ***
+    string heatFilename = string("./data/") + outFilename + "_heat" + to_string(window);
+    int failed = writeHeatmapImage(heatFilename + ".pgm", threadHeatmaps[0]);
+    failed |= writeHeatmapFile(heatFilename + ".heat", threadHeatmaps[0],
+                               window * windowLength, (window + 1) * windowLength);
+    clearHeatmap(threadHeatmaps[0]);
+    
+    // Return
+    return failed;
+}
+
+
+void publishAgentPositions(RVO::RVOSimulator* sim,
+                           int numActiveAgents,
+                           LiveStats& live)
+{
+    if (live.data == NULL) {
+        return;
+    }
+    
+    // Keep every stride-th active agent so that the snapshot fits
+    size_t stride = numActiveAgents / LIVE_MAX_POSITIONS + 1;
+    vector<float> coords;
+    size_t numActive = 0;
+    for (size_t i = 0; i < sim->getNumAgents(); i++) {
+        if (reachedPrimaryGoal[i]) {
+            continue;
+        }
+        if (numActive++ % stride == 0) {
+            coords.push_back(sim->getAgentPosition(i).x());
+            coords.push_back(sim->getAgentPosition(i).y());
+        }
+    }
+    publishLivePositions(live, coords, sim->getGlobalTime());
+}
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+
+#include "livestats.hpp"
+
+using namespace std;
+
+// Seconds between printed lines
+const unsigned int WATCH_INTERVAL = 1;
+
+// Phase names, in the order of LivePhase
+const char* PHASE_NAMES[LIVE_NUM_PHASES] = {"agents", "record", "velocities", "step"};
+
+
+/* Function to print a record on one line
+ *  Input(s):
+ *      LiveStatsRecord& record - record to be printed
+ */
+void printRecord(const LiveStatsRecord& record);
+
+
+/* Function to print the number and bounding box of the agents in the
+ * position snapshot
+ *  Input(s):
+ *      LiveStatsView& view - attached view
+ */
+void printPositions(const LiveStatsView& view);
+
+
+// Main Function
+int main(int argc, char* argv[])
+{
+    // Load Region Name
+    if (argc < 2) {
+        cout << "Usage: simwatch <LiveName> [-positions]" << endl;
+        return 1;
+    }
+    string name = argv[1];
+    bool showPositions = false;
+    for (int i = 2; i < argc; i++) {
+        string option = argv[i];
+        if (option == "-positions") {
+            showPositions = true;
+        } else {
+            cout << "ERROR - Unknown option " << option << endl;
+            return 1;
+        }
+    }
+
+    // Wait for the simulator to create the region
+    LiveStatsView view;
+    if (attachLiveStats(name, view)) {
+        cout << "Waiting for " << name << endl;
+        while (attachLiveStats(name, view)) {
+            sleep(WATCH_INTERVAL);
+        }
+    }
+    cout << "Watching simulator " << view.header->pid << endl;
+
+    // Print the latest record every interval until the simulator is done
+    uint64_t nextIndex = 0;
+    while (true) {
+        bool finished = __atomic_load_n(&view.header->finished, __ATOMIC_ACQUIRE) != 0;
+        bool alive = kill(view.header->pid, 0) == 0 || errno == EPERM;
+
+        // Skip records already overwritten, keeping the latest readable one
+        uint64_t numRecords = __atomic_load_n(&view.header->numRecords, __ATOMIC_ACQUIRE);
+        if (numRecords > nextIndex + LIVE_NUM_SLOTS) {
+            nextIndex = numRecords - LIVE_NUM_SLOTS;
+        }
+        LiveStatsRecord record;
+        bool haveRecord = false;
+        for (uint64_t index = numRecords; index-- > nextIndex; ) {
+            if (!readLiveStats(view, index, record)) {
+                haveRecord = true;
+                break;
+            }
+        }
+        nextIndex = numRecords;
+        if (haveRecord) {
+            printRecord(record);
+            if (showPositions) {
+                printPositions(view);
+            }
+        }
+
+        if (finished || !alive) {
+            cout << (finished ? "Simulation finished" : "Simulator exited") << endl;
+            break;
+        }
+        sleep(WATCH_INTERVAL);
+    }
+    detachLiveStats(view);
+
+    return 0;
+}
+
+
+void printRecord(const LiveStatsRecord& record)
+{
+    cout << fixed << setprecision(2)
+         << "Simulation Time: " << record.simTime/60.0 << " min"
+         << " | Step " << record.step
+         << " | " << setprecision(1) << record.stepRate << " steps/s"
+         << " | Agents " << record.activeAgents << "/" << record.totalAgents
+         << " | ms/step";
+    for (int p = 0; p < LIVE_NUM_PHASES; p++) {
+        cout << " " << PHASE_NAMES[p] << " " << setprecision(3) << record.phaseTimes[p];
+    }
+    cout << endl;
+}
+
+
+void printPositions(const LiveStatsView& view)
+{
+    vector<float> coords;
+    double simTime;
+    if (readLivePositions(view, coords, simTime) || coords.empty()) {
+        return;
+    }
+    float minX = coords[0], maxX = coords[0];
+    float minY = coords[1], maxY = coords[1];
+    for (size_t i = 2; i+1 < coords.size(); i += 2) {
+        minX = min(minX, coords[i]);
+        maxX = max(maxX, coords[i]);
+        minY = min(minY, coords[i+1]);
+        maxY = max(maxY, coords[i+1]);
+    }
+    cout << fixed << setprecision(2)
+         << "  Positions at " << simTime << " s: " << coords.size()/2 << " agents"
+         << " in [" << minX << ", " << maxX << "] x [" << minY << ", " << maxY << "]" << endl;
+}
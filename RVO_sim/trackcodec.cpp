@@ -0,0 +1,238 @@
+#include <iostream>
+#include <cmath>
+#include <cstring>
+
+#include "trackcodec.hpp"
+
+// File signature
+static const char TRACK_CODEC_MAGIC[8] = {'R','V','O','T','R','C','\0','\0'};
+
+
+/* Function to append an unsigned varint (7 bits per byte, low bits first)
+ *  Input(s):
+ *      uint64_t value      - value to be encoded
+ *  Output(s):
+ *      vector<uint8_t>& buffer - buffer the bytes are appended to
+ */
+static void putVarint(vector<uint8_t>& buffer,
+                      uint64_t value)
+{
+    while (value >= 0x80) {
+        buffer.push_back((uint8_t) (value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((uint8_t) value);
+}
+
+
+/* Function to read an unsigned varint
+ *  Input(s):
+ *      ifstream& in        - file being read
+ *  Output(s):
+ *      uint64_t& value     - decoded value
+ *      int                 - 0 if successful, 1 if truncated or too long
+ */
+static int getVarint(ifstream& in,
+                     uint64_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) {
+            return 1;
+        }
+        value |= (uint64_t) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+// Zig-zag mapping of signed to unsigned values (0, -1, 1, -2, ... to 0, 1, 2, 3, ...)
+static uint64_t zigzagEncode(int64_t value)
+{
+    return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+static int64_t zigzagDecode(uint64_t value)
+{
+    return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+
+/* Function to write the buffered tracklet of an encoder
+ *  Input(s):
+ *      TrackEncoder& encoder - encoder with a tracklet in progress
+ */
+static void flushTracklet(TrackEncoder& encoder)
+{
+    vector<uint8_t> header;
+    putVarint(header, encoder.trackID + 1);
+    putVarint(header, encoder.numPoints);
+    encoder.out.write((const char*) &header[0], header.size());
+    encoder.out.write((const char*) &encoder.buffer[0], encoder.buffer.size());
+    encoder.buffer.clear();
+    encoder.inTracklet = false;
+}
+
+
+int openTrackEncoder(string filename,
+                     double positionResolution,
+                     double timeResolution,
+                     TrackEncoder& encoder)
+{
+    if (!(positionResolution > 0.0) || !(timeResolution > 0.0)) {
+        cout << "ERROR - Track resolutions must be positive" << endl;
+        return 1;
+    }
+    encoder.out.open(filename.c_str(), ios::binary | ios::trunc);
+    if (!encoder.out.is_open()) {
+        cout << "ERROR - Unable to write track file " << filename << endl;
+        return 1;
+    }
+    encoder.positionResolution = positionResolution;
+    encoder.timeResolution = timeResolution;
+    encoder.inTracklet = false;
+    encoder.buffer.clear();
+
+    // Header
+    uint32_t version = TRACK_CODEC_VERSION;
+    encoder.out.write(TRACK_CODEC_MAGIC, sizeof(TRACK_CODEC_MAGIC));
+    encoder.out.write((const char*) &version, sizeof(version));
+    encoder.out.write((const char*) &positionResolution, sizeof(positionResolution));
+    encoder.out.write((const char*) &timeResolution, sizeof(timeResolution));
+
+    // Return
+    return encoder.out.good() ? 0 : 1;
+}
+
+
+int encodeTrackPoint(TrackEncoder& encoder,
+                     uint64_t trackID,
+                     double x,
+                     double y,
+                     double t)
+{
+    // Start a new tracklet when the track changes
+    if (encoder.inTracklet && trackID != encoder.trackID) {
+        flushTracklet(encoder);
+    }
+    if (!encoder.inTracklet) {
+        encoder.inTracklet = true;
+        encoder.trackID = trackID;
+        encoder.numPoints = 0;
+        for (int k = 0; k < 3; k++) {
+            encoder.prev[k] = 0;
+            encoder.prevDelta[k] = 0;
+        }
+    }
+
+    // Quantize, then store the change in each delta
+    int64_t q[3];
+    q[0] = llround(x / encoder.positionResolution);
+    q[1] = llround(y / encoder.positionResolution);
+    q[2] = llround(t / encoder.timeResolution);
+    for (int k = 0; k < 3; k++) {
+        int64_t delta = q[k] - encoder.prev[k];
+        putVarint(encoder.buffer, zigzagEncode(delta - encoder.prevDelta[k]));
+        encoder.prev[k] = q[k];
+        encoder.prevDelta[k] = delta;
+    }
+    encoder.numPoints++;
+
+    // Return
+    return encoder.out.good() ? 0 : 1;
+}
+
+
+int closeTrackEncoder(TrackEncoder& encoder)
+{
+    if (encoder.inTracklet) {
+        flushTracklet(encoder);
+    }
+    encoder.out.put(0);
+    encoder.out.close();
+
+    // Return
+    return encoder.out.fail() ? 1 : 0;
+}
+
+
+int openTrackDecoder(string filename,
+                     TrackDecoder& decoder)
+{
+    decoder.in.open(filename.c_str(), ios::binary);
+    if (!decoder.in.is_open()) {
+        return 1;
+    }
+
+    // Header
+    char magic[8];
+    uint32_t version = 0;
+    decoder.in.read(magic, sizeof(magic));
+    decoder.in.read((char*) &version, sizeof(version));
+    decoder.in.read((char*) &decoder.positionResolution, sizeof(decoder.positionResolution));
+    decoder.in.read((char*) &decoder.timeResolution, sizeof(decoder.timeResolution));
+    if (!decoder.in.good() ||
+        memcmp(magic, TRACK_CODEC_MAGIC, sizeof(magic)) != 0 ||
+        version != TRACK_CODEC_VERSION) {
+        decoder.in.close();
+        return 1;
+    }
+    decoder.remaining = 0;
+
+    // Return
+    return 0;
+}
+
+
+int decodeTrackPoint(TrackDecoder& decoder,
+                     uint64_t& trackID,
+                     double& x,
+                     double& y,
+                     double& t)
+{
+    // Read the next tracklet header, skipping empty tracklets
+    while (decoder.remaining == 0) {
+        uint64_t id, numPoints;
+        if (getVarint(decoder.in, id)) {
+            cout << "ERROR - Truncated track file" << endl;
+            return 1;
+        }
+        if (id == 0) {
+            return 1;
+        }
+        if (getVarint(decoder.in, numPoints)) {
+            cout << "ERROR - Truncated track file" << endl;
+            return 1;
+        }
+        decoder.trackID = id - 1;
+        decoder.remaining = numPoints;
+        for (int k = 0; k < 3; k++) {
+            decoder.prev[k] = 0;
+            decoder.prevDelta[k] = 0;
+        }
+    }
+
+    // Undo the changes in the deltas
+    for (int k = 0; k < 3; k++) {
+        uint64_t value;
+        if (getVarint(decoder.in, value)) {
+            cout << "ERROR - Truncated track file" << endl;
+            return 1;
+        }
+        decoder.prevDelta[k] += zigzagDecode(value);
+        decoder.prev[k] += decoder.prevDelta[k];
+    }
+    decoder.remaining--;
+
+    trackID = decoder.trackID;
+    x = decoder.prev[0] * decoder.positionResolution;
+    y = decoder.prev[1] * decoder.positionResolution;
+    t = decoder.prev[2] * decoder.timeResolution;
+
+    // Return
+    return 0;
+}
@@ -0,0 +1,131 @@
+#ifndef __TRACKCODEC_H_INCLUDED__
+#define __TRACKCODEC_H_INCLUDED__
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/* Compact encoding of tracks (.trc)
+ *  Points (x, y, t) are quantized to multiples of a position and a time
+ *  resolution. Consecutive points with the same track number form a
+ *  tracklet, stored as
+ *      varint(trackID + 1), varint(numPoints),
+ *      then per point and per value the zig-zag varint of the change in the
+ *      value's delta from the previous point (starting from 0),
+ *  so that points moving at constant velocity and rate take about a byte per
+ *  value. A varint of 0 ends the stream. The file starts with an 8-byte
+ *  signature, the version and the two resolutions (as doubles).
+ */
+static const uint32_t TRACK_CODEC_VERSION = 1;
+
+
+/* Encoder streaming points to a .trc file
+ *  Only the points of the current tracklet are held in memory.
+ *      ofstream out            - file being written
+ *      double positionResolution, timeResolution - quantization steps
+ *      bool inTracklet         - whether a tracklet has been started
+ *      uint64_t trackID        - track number of the current tracklet
+ *      uint64_t numPoints      - points in the current tracklet
+ *      int64_t prev[3], prevDelta[3] - last quantized x, y, t and their deltas
+ *      vector<uint8_t> buffer  - encoded points of the current tracklet
+ */
+struct TrackEncoder {
+    ofstream out;
+    double positionResolution;
+    double timeResolution;
+    bool inTracklet;
+    uint64_t trackID;
+    uint64_t numPoints;
+    int64_t prev[3];
+    int64_t prevDelta[3];
+    vector<uint8_t> buffer;
+};
+
+
+/* Decoder streaming points from a .trc file
+ *      ifstream in             - file being read
+ *      double positionResolution, timeResolution - quantization steps
+ *      uint64_t trackID        - track number of the current tracklet
+ *      uint64_t remaining      - points left in the current tracklet
+ *      int64_t prev[3], prevDelta[3] - last quantized x, y, t and their deltas
+ */
+struct TrackDecoder {
+    ifstream in;
+    double positionResolution;
+    double timeResolution;
+    uint64_t trackID;
+    uint64_t remaining;
+    int64_t prev[3];
+    int64_t prevDelta[3];
+};
+
+
+/* Function to create a .trc file
+ *  Input(s):
+ *      string filename     - file to be written
+ *      double positionResolution - quantization step of x and y
+ *      double timeResolution     - quantization step of t
+ *  Output(s):
+ *      TrackEncoder& encoder - opened encoder
+ *      int                 - 0 if successful, 1 if failed
+ */
+int openTrackEncoder(string filename,
+                     double positionResolution,
+                     double timeResolution,
+                     TrackEncoder& encoder);
+
+
+/* Function to encode the next point; points of a track must be consecutive
+ *  Input(s):
+ *      TrackEncoder& encoder - opened encoder
+ *      uint64_t trackID    - track number (a new tracklet starts when it changes)
+ *      double x, y, t      - point
+ *  Output(s):
+ *      int                 - 0 if successful, 1 if failed
+ */
+int encodeTrackPoint(TrackEncoder& encoder,
+                     uint64_t trackID,
+                     double x,
+                     double y,
+                     double t);
+
+
+/* Function to finish a .trc file
+ *  Input(s):
+ *      TrackEncoder& encoder - opened encoder
+ *  Output(s):
+ *      int                 - 0 if successful, 1 if failed
+ */
+int closeTrackEncoder(TrackEncoder& encoder);
+
+
+/* Function to open a .trc file
+ *  Input(s):
+ *      string filename     - file written by a TrackEncoder
+ *  Output(s):
+ *      TrackDecoder& decoder - opened decoder
+ *      int                 - 0 if successful, 1 if missing or not a .trc file
+ */
+int openTrackDecoder(string filename,
+                     TrackDecoder& decoder);
+
+
+/* Function to decode the next point
+ *  Input(s):
+ *      TrackDecoder& decoder - opened decoder
+ *  Output(s):
+ *      uint64_t& trackID   - track number of the point
+ *      double& x, y, t     - point (to within half the resolutions)
+ *      int                 - 0 if a point was read, 1 at the end of the stream
+ *                            or if it is corrupt
+ */
+int decodeTrackPoint(TrackDecoder& decoder,
+                     uint64_t& trackID,
+                     double& x,
+                     double& y,
+                     double& t);
+
+#endif  // __TRACKCODEC_H_INCLUDED__
@@ -0,0 +1,225 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "trackfile.hpp"
+
+// File signatures
+static const char TRACK_FILE_MAGIC[8] = {'R','V','O','T','R','A','C','K'};
+static const char TRACK_INDEX_MAGIC[8] = {'R','V','O','T','R','K','I','X'};
+
+
+int writeTrackFile(string filename,
+                   const vector< vector<RVO::Real> >& cameraTrack,
+                   size_t chunkSize)
+{
+    // Keep every column 8-byte aligned
+    chunkSize = (max(chunkSize, (size_t) 1) + 7) / 8 * 8;
+    size_t numPoints = cameraTrack.size() - 1;
+    size_t numChunks = (numPoints + chunkSize - 1) / chunkSize;
+
+    ofstream outFile(filename.c_str(), ios::binary | ios::trunc);
+    if (!outFile.is_open()) {
+        cout << "ERROR - Unable to write track file " << filename << endl;
+        return 1;
+    }
+
+    // Header
+    TrackFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACK_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRACK_FILE_VERSION;
+    header.camera = (uint32_t) cameraTrack[0][0];
+    header.chunkSize = (uint32_t) chunkSize;
+    header.numPoints = numPoints;
+    outFile.write((const char*) &header, sizeof(header));
+
+    // Chunks of columns
+    vector<TrackChunkEntry> chunks(numChunks);
+    vector<float> x(chunkSize), y(chunkSize);
+    vector<double> t(chunkSize);
+    vector<uint32_t> ids(chunkSize);
+    uint64_t offset = sizeof(header);
+    for (size_t c = 0; c < numChunks; c++) {
+        size_t first = c * chunkSize;
+        size_t count = min(chunkSize, numPoints - first);
+        fill(x.begin(), x.end(), 0.0f);
+        fill(y.begin(), y.end(), 0.0f);
+        fill(t.begin(), t.end(), 0.0);
+        fill(ids.begin(), ids.end(), 0);
+        chunks[c].offset = offset;
+        chunks[c].numPoints = count;
+        for (size_t i = 0; i < count; i++) {
+            const vector<RVO::Real>& row = cameraTrack[first + i + 1];
+            x[i] = row[0];
+            y[i] = row[1];
+            t[i] = row[2];
+            ids[i] = (uint32_t) row[3];
+            if (i == 0 || t[i] < chunks[c].minTime) {
+                chunks[c].minTime = t[i];
+            }
+            if (i == 0 || t[i] > chunks[c].maxTime) {
+                chunks[c].maxTime = t[i];
+            }
+        }
+        outFile.write((const char*) &x[0], chunkSize * sizeof(float));
+        outFile.write((const char*) &y[0], chunkSize * sizeof(float));
+        outFile.write((const char*) &t[0], chunkSize * sizeof(double));
+        outFile.write((const char*) &ids[0], chunkSize * sizeof(uint32_t));
+        offset += chunkSize * (2 * sizeof(float) + sizeof(double) + sizeof(uint32_t));
+    }
+
+    // Tracklets are the runs of points with the same track number
+    vector<TrackletEntry> tracklets;
+    for (size_t i = 0; i < numPoints; i++) {
+        const vector<RVO::Real>& row = cameraTrack[i + 1];
+        if (i == 0 || (uint64_t) row[3] != tracklets.back().trackID) {
+            TrackletEntry tracklet;
+            tracklet.trackID = (uint64_t) row[3];
+            tracklet.firstPoint = i;
+            tracklet.startTime = row[2];
+            tracklets.push_back(tracklet);
+        }
+        tracklets.back().endPoint = i + 1;
+    }
+
+    // Footer
+    TrackFileTrailer trailer;
+    trailer.chunksOffset = offset;
+    trailer.numChunks = numChunks;
+    trailer.trackletsOffset = offset + numChunks * sizeof(TrackChunkEntry);
+    trailer.numTracklets = tracklets.size();
+    memcpy(trailer.magic, TRACK_INDEX_MAGIC, sizeof(trailer.magic));
+    if (numChunks > 0) {
+        outFile.write((const char*) &chunks[0], numChunks * sizeof(TrackChunkEntry));
+    }
+    if (!tracklets.empty()) {
+        outFile.write((const char*) &tracklets[0], tracklets.size() * sizeof(TrackletEntry));
+    }
+    outFile.write((const char*) &trailer, sizeof(trailer));
+
+    if (!outFile.good()) {
+        cout << "ERROR - Unable to write track file " << filename << endl;
+        return 1;
+    }
+
+    // Return
+    return 0;
+}
+
+
+int openTrackFile(string filename,
+                  TrackFile& file)
+{
+    memset(&file, 0, sizeof(file));
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (size_t) st.st_size < sizeof(TrackFileHeader) + sizeof(TrackFileTrailer)) {
+        close(fd);
+        return 1;
+    }
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return 1;
+    }
+    file.data = (const char*) data;
+    file.size = st.st_size;
+
+    // Check the header, trailer and that the indices lie within the file
+    file.header = (const TrackFileHeader*) file.data;
+    const TrackFileTrailer* trailer =
+        (const TrackFileTrailer*) (file.data + file.size - sizeof(TrackFileTrailer));
+    size_t footerEnd = file.size - sizeof(TrackFileTrailer);
+    if (memcmp(file.header->magic, TRACK_FILE_MAGIC, sizeof(TRACK_FILE_MAGIC)) != 0 ||
+        file.header->version != TRACK_FILE_VERSION ||
+        memcmp(trailer->magic, TRACK_INDEX_MAGIC, sizeof(TRACK_INDEX_MAGIC)) != 0 ||
+        trailer->chunksOffset > footerEnd ||
+        trailer->numChunks > (footerEnd - trailer->chunksOffset) / sizeof(TrackChunkEntry) ||
+        trailer->trackletsOffset > footerEnd ||
+        trailer->numTracklets > (footerEnd - trailer->trackletsOffset) / sizeof(TrackletEntry) ||
+        file.header->chunkSize == 0 ||
+        file.header->numPoints / file.header->chunkSize +
+            (file.header->numPoints % file.header->chunkSize != 0) > trailer->numChunks) {
+        closeTrackFile(file);
+        return 1;
+    }
+    file.chunks = (const TrackChunkEntry*) (file.data + trailer->chunksOffset);
+
+    // Check that every chunk lies within the file
+    uint64_t chunkBytes = (uint64_t) file.header->chunkSize *
+                          (2*sizeof(float) + sizeof(double) + sizeof(uint32_t));
+    for (uint64_t c = 0; c < trailer->numChunks; c++) {
+        if (file.chunks[c].offset > file.size ||
+            chunkBytes > file.size - file.chunks[c].offset ||
+            file.chunks[c].numPoints > file.header->chunkSize) {
+            closeTrackFile(file);
+            return 1;
+        }
+    }
+    file.tracklets = (const TrackletEntry*) (file.data + trailer->trackletsOffset);
+    file.numChunks = trailer->numChunks;
+    file.numTracklets = trailer->numTracklets;
+
+    // Return
+    return 0;
+}
+
+
+void closeTrackFile(TrackFile& file)
+{
+    if (file.data != NULL) {
+        munmap((void*) file.data, file.size);
+    }
+    memset(&file, 0, sizeof(file));
+}
+
+
+void getTrackFilePoint(const TrackFile& file,
+                       size_t pointNo,
+                       float& x,
+                       float& y,
+                       double& t,
+                       uint32_t& trackID)
+{
+    size_t chunkSize = file.header->chunkSize;
+    const char* chunk = file.data + file.chunks[pointNo / chunkSize].offset;
+    size_t i = pointNo % chunkSize;
+    x = ((const float*) chunk)[i];
+    y = ((const float*) (chunk + chunkSize * sizeof(float)))[i];
+    t = ((const double*) (chunk + 2 * chunkSize * sizeof(float)))[i];
+    trackID = ((const uint32_t*) (chunk + 2 * chunkSize * sizeof(float) +
+                                  chunkSize * sizeof(double)))[i];
+}
+
+
+void queryTrackFileTime(const TrackFile& file,
+                        double startTime,
+                        double endTime,
+                        vector<size_t>& points)
+{
+    size_t chunkSize = file.header->chunkSize;
+    points.clear();
+    for (size_t c = 0; c < file.numChunks; c++) {
+        // Skip chunks entirely outside the range
+        if (file.chunks[c].maxTime < startTime || file.chunks[c].minTime > endTime) {
+            continue;
+        }
+        const double* t = (const double*) (file.data + file.chunks[c].offset +
+                                           2 * chunkSize * sizeof(float));
+        for (size_t i = 0; i < file.chunks[c].numPoints; i++) {
+            if (t[i] >= startTime && t[i] <= endTime) {
+                points.push_back(c * chunkSize + i);
+            }
+        }
+    }
+}
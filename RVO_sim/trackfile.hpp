@@ -0,0 +1,139 @@
+#ifndef __TRACKFILE_H_INCLUDED__
+#define __TRACKFILE_H_INCLUDED__
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "RVO.h"
+
+using namespace std;
+
+/* Chunked binary file of one camera's observations (<OutputFileBase>_cam<N>.trk)
+ *  The file holds the same points as the camera's .csv file, in the same
+ *  order, as a header followed by chunks of chunkSize points and a footer:
+ *      header    - TrackFileHeader
+ *      chunks    - per chunk, the columns float x[chunkSize], float y[chunkSize],
+ *                  double t[chunkSize] (in ms) and uint32 trackID[chunkSize];
+ *                  the last chunk is padded with zeros
+ *      footer    - TrackChunkEntry per chunk, TrackletEntry per tracklet, and
+ *                  a TrackFileTrailer at the very end of the file
+ *  All values are little-endian and every structure is 8-byte aligned, so the
+ *  file can be mapped into memory and read in place.
+ */
+static const uint32_t TRACK_FILE_VERSION = 1;
+
+struct TrackFileHeader {
+    char magic[8];              // "RVOTRACK"
+    uint32_t version;           // TRACK_FILE_VERSION
+    uint32_t camera;            // camera number
+    uint32_t chunkSize;         // points per chunk (a multiple of 8)
+    uint32_t reserved;
+    uint64_t numPoints;         // points in the file
+};
+
+struct TrackChunkEntry {
+    uint64_t offset;            // file offset of the chunk's x column
+    uint64_t numPoints;         // points used in the chunk
+    double minTime;             // earliest t in the chunk (in ms)
+    double maxTime;             // latest t in the chunk (in ms)
+};
+
+struct TrackletEntry {
+    uint64_t trackID;           // ground truth track number
+    uint64_t firstPoint;        // index of the tracklet's first point
+    uint64_t endPoint;          // index one past the tracklet's last point
+    double startTime;           // t of the first point (in ms)
+};
+
+struct TrackFileTrailer {
+    uint64_t chunksOffset;      // file offset of the TrackChunkEntry array
+    uint64_t numChunks;
+    uint64_t trackletsOffset;   // file offset of the TrackletEntry array
+    uint64_t numTracklets;
+    char magic[8];              // "RVOTRKIX"
+};
+
+
+/* Memory-mapped track file opened by openTrackFile
+ *      const char* data        - start of the mapping
+ *      size_t size             - size of the file
+ *      TrackFileHeader* header - header of the file
+ *      TrackChunkEntry* chunks - chunk index
+ *      TrackletEntry* tracklets - tracklet index
+ *      size_t numChunks, numTracklets - sizes of the indices
+ */
+struct TrackFile {
+    const char* data;
+    size_t size;
+    const TrackFileHeader* header;
+    const TrackChunkEntry* chunks;
+    const TrackletEntry* tracklets;
+    size_t numChunks;
+    size_t numTracklets;
+};
+
+
+/* Function to write one camera's observations to a track file
+ *  Input(s):
+ *      string filename     - file to be written
+ *      vector<vector<RVO::Real>> cameraTrack - camera's rows as stored in
+ *                            cameraTracks ([[cam#,0,0,0],[x,y,t,tr#], ...])
+ *      size_t chunkSize    - points per chunk (rounded up to a multiple of 8)
+ *  Output(s):
+ *      int                 - 0 if successful, 1 if failed
+ */
+int writeTrackFile(string filename,
+                   const vector< vector<RVO::Real> >& cameraTrack,
+                   size_t chunkSize);
+
+
+/* Function to map a track file into memory and check its structure
+ *  Input(s):
+ *      string filename     - file written by writeTrackFile
+ *  Output(s):
+ *      TrackFile& file     - mapped file
+ *      int                 - 0 if successful, 1 if missing or corrupt
+ */
+int openTrackFile(string filename,
+                  TrackFile& file);
+
+
+/* Function to unmap a track file
+ *  Input(s):
+ *      TrackFile& file     - file opened by openTrackFile
+ */
+void closeTrackFile(TrackFile& file);
+
+
+/* Function to read a point of a track file
+ *  Input(s):
+ *      TrackFile& file     - mapped file
+ *      size_t pointNo      - index of the point (in file order)
+ *  Output(s):
+ *      float& x, y         - position in camera coords
+ *      double& t           - time (in ms)
+ *      uint32_t& trackID   - ground truth track number
+ */
+void getTrackFilePoint(const TrackFile& file,
+                       size_t pointNo,
+                       float& x,
+                       float& y,
+                       double& t,
+                       uint32_t& trackID);
+
+
+/* Function to find the points of a track file within a time range, reading
+ * only the chunks whose time range overlaps it
+ *  Input(s):
+ *      TrackFile& file     - mapped file
+ *      double startTime    - start of the range (in ms)
+ *      double endTime      - end of the range (in ms)
+ *  Output(s):
+ *      vector<size_t>& points - indices of the points with startTime <= t <= endTime
+ */
+void queryTrackFileTime(const TrackFile& file,
+                        double startTime,
+                        double endTime,
+                        vector<size_t>& points);
+
+#endif  // __TRACKFILE_H_INCLUDED__
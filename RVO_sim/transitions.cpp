@@ -0,0 +1,122 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+#include "transitions.hpp"
+
+
+/* Function to add one transition to a matrix
+ *  Input(s):
+ *      size_t from, to     - cameras of the previous and the new tracklet
+ *      double travelTime   - time between them (in seconds)
+ *  Output(s):
+ *      TransitionStats& stats - updated matrix
+ */
+static void addTransition(size_t from,
+                          size_t to,
+                          double travelTime,
+                          TransitionStats& stats)
+{
+    TransitionCell& cell = stats.cells[from*stats.numCameras + to];
+    if (cell.histogram.empty()) {
+        cell.count = 0;
+        cell.totalTime = 0.0;
+        cell.histogram.assign(TRANSITION_HISTOGRAM_BINS, 0);
+    }
+    size_t bin = TRANSITION_HISTOGRAM_BINS - 1;
+    if (travelTime / stats.binWidth < bin) {
+        bin = (size_t) max(travelTime / stats.binWidth, 0.0);
+    }
+    cell.count++;
+    cell.totalTime += travelTime;
+    cell.histogram[bin]++;
+}
+
+
+void initTransitionStats(size_t numCameras,
+                         double binWidth,
+                         TransitionStats& stats)
+{
+    stats.numCameras = numCameras;
+    stats.binWidth = binWidth;
+    stats.cells.clear();
+}
+
+
+void updateTrackCameras(TrackCameraState& state,
+                        const vector<size_t>& cams,
+                        double t,
+                        TransitionStats& stats)
+{
+    // Start tracklets in the cameras that did not see the previous point
+    // (the travel time is 0 while the camera of the previous tracklet still
+    // sees the track)
+    int newLastCam = state.lastCam;
+    bool lastCamSees = state.lastCam >= 0 &&
+                       binary_search(cams.begin(), cams.end(), (size_t) state.lastCam);
+    double travelTime = lastCamSees ? 0.0 : t - state.lastTime;
+    for (size_t k = 0; k < cams.size(); k++) {
+        if (binary_search(state.cams.begin(), state.cams.end(), cams[k])) {
+            continue;
+        }
+        if (state.lastCam >= 0 && (size_t) state.lastCam != cams[k]) {
+            addTransition(state.lastCam, cams[k], travelTime, stats);
+        }
+        newLastCam = cams[k];
+    }
+
+    // Keep the time the camera of the latest tracklet last saw the track
+    if (newLastCam >= 0 && binary_search(cams.begin(), cams.end(), (size_t) newLastCam)) {
+        state.lastTime = t;
+    }
+    state.lastCam = newLastCam;
+    state.cams = cams;
+}
+
+
+void mergeTransitionStats(const TransitionStats& from,
+                          TransitionStats& into)
+{
+    for (map<uint64_t, TransitionCell>::const_iterator it = from.cells.begin();
+         it != from.cells.end(); ++it) {
+        TransitionCell& cell = into.cells[it->first];
+        if (cell.histogram.empty()) {
+            cell = it->second;
+            continue;
+        }
+        cell.count += it->second.count;
+        cell.totalTime += it->second.totalTime;
+        for (size_t b = 0; b < TRANSITION_HISTOGRAM_BINS; b++) {
+            cell.histogram[b] += it->second.histogram[b];
+        }
+    }
+}
+
+
+int writeTransitionStats(string filename,
+                         const TransitionStats& stats)
+{
+    ofstream outFile(filename.c_str(), ios::trunc);
+    if (!outFile.is_open()) {
+        cout << "ERROR - Unable to write transitions to " << filename << endl;
+        return 1;
+    }
+
+    // One row per pair of cameras with transitions, in order of the cameras
+    for (map<uint64_t, TransitionCell>::const_iterator it = stats.cells.begin();
+         it != stats.cells.end(); ++it) {
+        const TransitionCell& cell = it->second;
+        outFile << it->first / stats.numCameras << " "
+        << it->first % stats.numCameras << " "
+        << cell.count << " "
+        << cell.totalTime / cell.count;
+        for (size_t b = 0; b < TRANSITION_HISTOGRAM_BINS; b++) {
+            outFile << " " << cell.histogram[b];
+        }
+        outFile << "\n";
+    }
+    outFile.close();
+
+    // Return
+    return outFile.fail() ? 1 : 0;
+}
@@ -0,0 +1,107 @@
+#ifndef __TRANSITIONS_H_INCLUDED__
+#define __TRANSITIONS_H_INCLUDED__
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/* Transitions of tracks between cameras
+ *  A tracklet is a run of consecutive points of a track seen by one camera,
+ *  and a transition from camera i to camera j is a tracklet starting in j
+ *  when the track's previous tracklet was in i. Its travel time is the time
+ *  from the last point seen by i to the first point seen by j (0 if i still
+ *  sees the track).
+ */
+static const size_t TRANSITION_HISTOGRAM_BINS = 32;
+
+
+/* Transitions between one pair of cameras
+ *      uint64_t count          - number of transitions
+ *      double totalTime        - summed travel time (in seconds)
+ *      vector<uint64_t> histogram - transitions per travel time bin, the last
+ *                                   bin holding all longer times
+ */
+struct TransitionCell {
+    uint64_t count;
+    double totalTime;
+    vector<uint64_t> histogram;
+};
+
+
+/* Sparse camera x camera matrix of transitions
+ *      size_t numCameras       - number of cameras
+ *      double binWidth         - width of the histogram bins (in seconds)
+ *      map<uint64_t,TransitionCell> cells - transitions from camera i to camera j,
+ *                                           at key i*numCameras + j
+ */
+struct TransitionStats {
+    size_t numCameras;
+    double binWidth;
+    map<uint64_t, TransitionCell> cells;
+};
+
+
+/* Last camera state of a track
+ *      int lastCam             - camera of the track's latest tracklet, or -1
+ *      double lastTime         - last time lastCam saw the track
+ *      vector<size_t> cams     - cameras seeing the track's latest point
+ */
+struct TrackCameraState {
+    int lastCam;
+    double lastTime;
+    vector<size_t> cams;
+};
+
+
+/* Function to clear a transition matrix
+ *  Input(s):
+ *      size_t numCameras   - number of cameras
+ *      double binWidth     - width of the histogram bins (in seconds)
+ *  Output(s):
+ *      TransitionStats& stats - empty matrix
+ */
+void initTransitionStats(size_t numCameras,
+                         double binWidth,
+                         TransitionStats& stats);
+
+
+/* Function to advance a track by one point and record its transitions
+ *  Input(s):
+ *      TrackCameraState& state - state of the track (lastCam -1 and no cams
+ *                                before its first point)
+ *      vector<size_t> cams     - cameras seeing the point, in increasing order
+ *      double t                - time of the point (in seconds)
+ *  Output(s):
+ *      TrackCameraState& state - updated state
+ *      TransitionStats& stats  - matrix the transitions are added to
+ */
+void updateTrackCameras(TrackCameraState& state,
+                        const vector<size_t>& cams,
+                        double t,
+                        TransitionStats& stats);
+
+
+/* Function to add the transitions of one matrix to another
+ *  Input(s):
+ *      TransitionStats& from - matrix to be added, with the same bins
+ *  Output(s):
+ *      TransitionStats& into - sum of both matrices
+ */
+void mergeTransitionStats(const TransitionStats& from,
+                          TransitionStats& into);
+
+
+/* Function to write the non-empty pairs of a transition matrix
+ *  Input(s):
+ *      string filename     - file to be written
+ *      TransitionStats& stats - transitions
+ *  Output(s):
+ *      int                 - 0 if successful, 1 if failed
+ */
+int writeTransitionStats(string filename,
+                         const TransitionStats& stats);
+
+#endif  // __TRANSITIONS_H_INCLUDED__